@@ -1,11 +1,55 @@
 SOURCE= src/wavefront_object.c \
-	src/wavefront_object_parser.c
+	src/wavefront_object_batch.c \
+	src/wavefront_object_bvh.c \
+	src/wavefront_object_incremental.c \
+	src/wavefront_object_mesh.c \
+	src/wavefront_object_parser.c \
+	src/wavefront_object_quantize.c \
+	src/wavefront_object_reorder.c \
+	src/wavefront_object_scan.c \
+	src/wavefront_object_simplify.c \
+	src/wavefront_object_stream.c
 TEST_SOURCE= \
 	src/test.c \
-	src/wavefront_object_parser_test.c
-LIBRARIES=-lcutil -L ../cutil/bin
+	src/wavefront_object_batch_test.c \
+	src/wavefront_object_bvh_test.c \
+	src/wavefront_object_incremental_test.c \
+	src/wavefront_object_mesh_test.c \
+	src/wavefront_object_parser_test.c \
+	src/wavefront_object_quantize_test.c \
+	src/wavefront_object_reorder_test.c \
+	src/wavefront_object_scan_test.c \
+	src/wavefront_object_simplify_test.c \
+	src/wavefront_object_stream_test.c
+FUZZ_SOURCE=src/wavefront_object_fuzz.c
+FUZZ_RUNS=1000
+FUZZ_SANITIZE=address,undefined
+LIBRARIES=-lcutil -L ../cutil/bin -lz -lpthread -lm
 INCLUDES=-I../
 
+# 64 bit counts and indices for very large models, enable with make LARGE=1.
+ifeq ($(LARGE),1)
+	DEFINES+=-DCOBJ_LARGE
+endif
+
+# Delimiter scans use SSE2 where available, make AVX2=1 widens them to 32 bytes.
+ifeq ($(AVX2),1)
+	CFLAGS_ARCH+=-mavx2
+endif
+
+# Zstandard input is optional, enable with make ZSTD=1.
+ifeq ($(ZSTD),1)
+	DEFINES+=-DCOBJ_ZSTD
+	LIBRARIES+=-lzstd
+endif
+
+# make fuzz runs the built in mutator, LIBFUZZER=1 hands the target to
+# libFuzzer instead and needs clang, make fuzz CC=clang LIBFUZZER=1.
+ifeq ($(LIBFUZZER),1)
+	DEFINES+=-DCOBJ_LIBFUZZER
+	FUZZ_SANITIZE:=fuzzer,$(FUZZ_SANITIZE)
+endif
+
 COVERAGE_CC=gcc
 ifeq ($(shell uname -s),Darwin)
 	CC=gcc
@@ -3,10 +3,28 @@
 int asserts_passed = 0;
 int asserts_failed = 0;
 
+void wavefrontObjectBatchTest();
+void wavefrontObjectBvhTest();
+void wavefrontObjectIncrementalTest();
+void wavefrontObjectMeshTest();
 void wavefrontObjectParserTest();
+void wavefrontObjectQuantizeTest();
+void wavefrontObjectReorderTest();
+void wavefrontObjectScanTest();
+void wavefrontObjectSimplifyTest();
+void wavefrontObjectStreamTest();
 
 int main() {
     wavefrontObjectParserTest();
+    wavefrontObjectBatchTest();
+    wavefrontObjectBvhTest();
+    wavefrontObjectIncrementalTest();
+    wavefrontObjectMeshTest();
+    wavefrontObjectQuantizeTest();
+    wavefrontObjectReorderTest();
+    wavefrontObjectScanTest();
+    wavefrontObjectSimplifyTest();
+    wavefrontObjectStreamTest();
 
     printf("Asserts Passed: %d, Failed: %d\n",
         asserts_passed, asserts_failed);
@@ -3,6 +3,40 @@
 #include "cutil/src/string.h"
 #include "wavefront_object.h"
 
+// Make room for element count of an array, doubling its capacity. New slots
+// are zeroed so the ones left unused are safe to release. Fails rather than
+// let a count pass WAVEFRONT_OBJECT_COUNT_MAX or the byte size wrap.
+static void *reserve(void *data, WavefrontObjectCount *capacity, WavefrontObjectCount count, size_t size) {
+    if(count < *capacity) return data;
+    if(count >= (WavefrontObjectCount)WAVEFRONT_OBJECT_COUNT_MAX) return NULL;
+    WavefrontObjectCount grown = *capacity ? *capacity : 2;
+    grown = grown > (WavefrontObjectCount)WAVEFRONT_OBJECT_COUNT_MAX / 2 ? WAVEFRONT_OBJECT_COUNT_MAX : grown * 2;
+    if(grown <= count) grown = count + 1;
+    if(grown > (size_t)-1 / size) return NULL;
+    char *temp = (char*)realloc(data, (size_t)grown * size);
+    if(temp == NULL) return NULL;
+    memset(temp + (size_t)count * size, 0, (size_t)(grown - count) * size);
+    *capacity = grown;
+    return temp;
+}
+
+// Copy name into a slot, reusing the string left there when it is long enough.
+static int copyName(char **slot, const char *name) {
+    if(*slot && strlen(*slot) >= strlen(name)) {
+        strcpy(*slot, name);
+        return STATUS_OK;
+    }
+    char *temp = strCopy(name);
+    if(temp == NULL) return STATUS_ALLOC_ERR;
+    free(*slot);
+    *slot = temp;
+    return STATUS_OK;
+}
+
+static WavefrontObjectCount slotCount(WavefrontObjectCount count, WavefrontObjectCount capacity) {
+    return count > capacity ? count : capacity;
+}
+
 static struct WavefrontObjectObject *getObject(
         struct WavefrontObject *obj) {
     char defaultName[] = "";
@@ -10,8 +44,7 @@ static struct WavefrontObjectObject *getObject(
         // Create a default object.
         if(wavefrontObjectAddObject(obj, defaultName)) return NULL;
     }
-    unsigned int index = obj->currentObject;
-    return obj->objects + index;
+    return obj->objects + obj->currentObject;
 }
 
 int wavefrontObjectCompose(struct WavefrontObject *obj) {
@@ -21,14 +54,42 @@ int wavefrontObjectCompose(struct WavefrontObject *obj) {
     return STATUS_OK;
 }
 
+// Grows the points by one from pointCount alone. Callers that only set points
+// and pointCount never had to set pointCapacity, so it is written here but
+// never read.
 int wavefrontObjectFaceAddPoint(
         struct WavefrontObjectFace *face,
         struct WavefrontObjectPoint *point) {
-    struct WavefrontObjectPoint *temp = (struct WavefrontObjectPoint*) realloc(face->points,
-        (face->pointCount + 1) * sizeof(struct WavefrontObjectPoint));
+    if(face->pointCount >= (WavefrontObjectCount)WAVEFRONT_OBJECT_COUNT_MAX) return STATUS_ALLOC_ERR;
+    if(face->pointCount + 1 > (size_t)-1 / sizeof(struct WavefrontObjectPoint)) return STATUS_ALLOC_ERR;
+    struct WavefrontObjectPoint *temp = (struct WavefrontObjectPoint*)realloc(
+        face->points,
+        (size_t)(face->pointCount + 1) * sizeof(struct WavefrontObjectPoint));
     if(temp == NULL) return STATUS_ALLOC_ERR;
     face->points = temp;
     face->points[face->pointCount++] = *point;
+    face->pointCapacity = face->pointCount;
+    return STATUS_OK;
+}
+
+// Replace the points of a slot from wavefrontObjectNextFace, reusing the
+// buffer a reset object kept there when it is large enough. Only slots trust
+// pointCapacity, wavefrontObjectAddFace sets it for faces built elsewhere.
+int wavefrontObjectFaceSetPoints(
+        struct WavefrontObjectFace *face,
+        const struct WavefrontObjectPoint *points,
+        WavefrontObjectCount pointCount) {
+    if(pointCount > face->pointCapacity) {
+        if(pointCount > (size_t)-1 / sizeof(struct WavefrontObjectPoint)) return STATUS_ALLOC_ERR;
+        struct WavefrontObjectPoint *temp = (struct WavefrontObjectPoint*)realloc(
+            face->points,
+            (size_t)pointCount * sizeof(struct WavefrontObjectPoint));
+        if(temp == NULL) return STATUS_ALLOC_ERR;
+        face->points = temp;
+        face->pointCapacity = pointCount;
+    }
+    if(pointCount) memcpy(face->points, points, (size_t)pointCount * sizeof(struct WavefrontObjectPoint));
+    face->pointCount = pointCount;
     return STATUS_OK;
 }
 
@@ -37,29 +98,31 @@ void wavefrontObjectFaceFree(struct WavefrontObjectFace *face) {
 }
 
 void wavefrontObjectRelease(struct WavefrontObject *obj) {
-    unsigned int materialLibraryIndex;
+    WavefrontObjectCount materialLibraryIndex;
     for(materialLibraryIndex = 0;
-        materialLibraryIndex < obj->materialLibraryCount;
+        materialLibraryIndex < slotCount(obj->materialLibraryCount, obj->materialLibraryCapacity);
         materialLibraryIndex++) {
         free(obj->materialLibraries[materialLibraryIndex]);
     }
     free(obj->materialLibraries);
 
-    for(unsigned int i = 0; i < obj->objectCount; i++) {
+    for(WavefrontObjectCount i = 0; i < slotCount(obj->objectCount, obj->objectCapacity); i++) {
         struct WavefrontObjectObject o = obj->objects[i];
         free(o.name);
 
-        unsigned int faceIndex;
+        WavefrontObjectCount faceIndex;
         for(faceIndex = 0;
-            faceIndex < o.faceCount;
+            faceIndex < slotCount(o.faceCount, o.faceCapacity);
             faceIndex++) {
             wavefrontObjectFaceFree(o.faces + faceIndex);
         }
         free(o.faces);
     }
-    unsigned int materialIndex;
+    free(obj->objects);
+
+    WavefrontObjectCount materialIndex;
     for(materialIndex = 0;
-        materialIndex < obj->materialCount;
+        materialIndex < slotCount(obj->materialCount, obj->materialCapacity);
         materialIndex++) {
         free(obj->materials[materialIndex]);
     }
@@ -70,12 +133,59 @@ void wavefrontObjectRelease(struct WavefrontObject *obj) {
     free(obj->normals);
 }
 
+// Empty the object but keep every buffer, so parsing a similar model into it
+// again allocates nothing. Objects built by setting counts directly have no
+// capacities, so the counts become them before they are zeroed, and a face
+// in use is only trusted to hold its points.
+void wavefrontObjectReset(struct WavefrontObject *obj) {
+    obj->materialLibraryCapacity = slotCount(obj->materialLibraryCount, obj->materialLibraryCapacity);
+    obj->vertexCapacity = slotCount(obj->vertexCount, obj->vertexCapacity);
+    obj->unwrapCapacity = slotCount(obj->unwrapCount, obj->unwrapCapacity);
+    obj->normalCapacity = slotCount(obj->normalCount, obj->normalCapacity);
+    obj->objectCapacity = slotCount(obj->objectCount, obj->objectCapacity);
+    obj->materialCapacity = slotCount(obj->materialCount, obj->materialCapacity);
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        struct WavefrontObjectObject *o = obj->objects + i;
+        o->faceCapacity = slotCount(o->faceCount, o->faceCapacity);
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            o->faces[j].pointCapacity = o->faces[j].pointCount;
+            o->faces[j].pointCount = 0;
+        }
+        o->faceCount = 0;
+    }
+    obj->materialLibraryCount = 0;
+    obj->vertexCount = 0;
+    obj->unwrapCount = 0;
+    obj->normalCount = 0;
+    obj->objectCount = 0;
+    obj->materialCount = 0;
+    obj->currentMaterial = -1;
+    obj->currentObject = -1;
+}
+
+// The empty face slot wavefrontObjectAddFace fills next. Building a face in
+// place reuses the points left there by wavefrontObjectReset.
+struct WavefrontObjectFace *wavefrontObjectNextFace(struct WavefrontObject *obj) {
+    struct WavefrontObjectObject *o = getObject(obj);
+    if(o == NULL) return NULL;
+    struct WavefrontObjectFace *temp = (struct WavefrontObjectFace*)reserve(
+        o->faces,
+        &o->faceCapacity,
+        o->faceCount,
+        sizeof(struct WavefrontObjectFace));
+    if(temp == NULL) return NULL;
+    o->faces = temp;
+    return o->faces + o->faceCount;
+}
+
 int wavefrontObjectAddVertex(
         struct WavefrontObject *obj,
         struct WavefrontObjectVertex *vertex) {
-    struct WavefrontObjectVertex *temp = (struct WavefrontObjectVertex*)realloc(
+    struct WavefrontObjectVertex *temp = (struct WavefrontObjectVertex*)reserve(
         obj->vertices,
-        (obj->vertexCount + 1) * sizeof(struct WavefrontObjectVertex));
+        &obj->vertexCapacity,
+        obj->vertexCount,
+        sizeof(struct WavefrontObjectVertex));
     if(temp == NULL) return STATUS_ALLOC_ERR;
     obj->vertices = temp;
     obj->vertices[obj->vertexCount++] = *vertex;
@@ -85,9 +195,11 @@ int wavefrontObjectAddVertex(
 int wavefrontObjectAddUnwrap(
         struct WavefrontObject *obj,
         struct WavefrontObjectUnwrap *unwrap) {
-    struct WavefrontObjectUnwrap *temp = (struct WavefrontObjectUnwrap*)realloc(
+    struct WavefrontObjectUnwrap *temp = (struct WavefrontObjectUnwrap*)reserve(
         obj->unwraps,
-        (obj->unwrapCount + 1) * sizeof(struct WavefrontObjectUnwrap));
+        &obj->unwrapCapacity,
+        obj->unwrapCount,
+        sizeof(struct WavefrontObjectUnwrap));
     if(temp == NULL) return STATUS_ALLOC_ERR;
     obj->unwraps = temp;
     obj->unwraps[obj->unwrapCount++] = *unwrap;
@@ -97,9 +209,11 @@ int wavefrontObjectAddUnwrap(
 int wavefrontObjectAddNormal(
         struct WavefrontObject *obj,
         struct WavefrontObjectNormal *normal) {
-    struct WavefrontObjectNormal *temp = (struct WavefrontObjectNormal*)realloc(
+    struct WavefrontObjectNormal *temp = (struct WavefrontObjectNormal*)reserve(
         obj->normals,
-        (obj->normalCount + 1) * sizeof(struct WavefrontObjectNormal));
+        &obj->normalCapacity,
+        obj->normalCount,
+        sizeof(struct WavefrontObjectNormal));
     if(temp == NULL) return STATUS_ALLOC_ERR;
     obj->normals = temp;
     obj->normals[obj->normalCount++] = *normal;
@@ -109,61 +223,55 @@ int wavefrontObjectAddNormal(
 int wavefrontObjectAddFace(
       struct WavefrontObject *obj,
       struct WavefrontObjectFace *face) {
-    struct WavefrontObjectObject *o = getObject(obj);
-    if(o == NULL) return STATUS_ALLOC_ERR;
+    // face may be the slot returned by wavefrontObjectNextFace, which keeps it in place.
+    struct WavefrontObjectFace *slot = wavefrontObjectNextFace(obj);
+    if(slot == NULL) return STATUS_ALLOC_ERR;
     face->material = obj->currentMaterial;
-
-    struct WavefrontObjectFace *temp = (struct WavefrontObjectFace*)realloc(
-        o->faces,
-        (o->faceCount + 1) * sizeof(struct WavefrontObjectFace));
-    if(temp == NULL) return STATUS_ALLOC_ERR;
-    o->faces = temp;
-    o->faces[o->faceCount++] = *face;
+    if(slot != face) {
+        wavefrontObjectFaceFree(slot);
+        *slot = *face;
+        slot->pointCapacity = face->pointCount;
+    }
+    obj->objects[obj->currentObject].faceCount++;
     return STATUS_OK;
 }
 
 int wavefrontObjectAddMaterialLibrary(
       struct WavefrontObject *obj,
       const char *materialLibrary) {
-    char *temp = strCopy(materialLibrary);
-    if(temp == NULL) {
-        return STATUS_ALLOC_ERR;
-    }
-
-    char **tempMtls = (char**)realloc(obj->materialLibraries,
-        (obj->materialLibraryCount + 1) * sizeof(char*));
-    if(tempMtls == NULL) {
-        free(temp);
+    char **tempMtls = (char**)reserve(
+        obj->materialLibraries,
+        &obj->materialLibraryCapacity,
+        obj->materialLibraryCount,
+        sizeof(char*));
+    if(tempMtls == NULL) return STATUS_ALLOC_ERR;
+    obj->materialLibraries = tempMtls;
+    if(copyName(obj->materialLibraries + obj->materialLibraryCount, materialLibrary)) {
         return STATUS_ALLOC_ERR;
     }
-    obj->materialLibraries = tempMtls;
-    obj->materialLibraries[obj->materialLibraryCount++] = temp;
+    obj->materialLibraryCount++;
     return STATUS_OK;
 }
 
 int wavefrontObjectAddMaterial(
       struct WavefrontObject *obj,
       const char *material) {
-    for (unsigned int i = 0; i < obj->materialCount; i++) {
+    for (WavefrontObjectCount i = 0; i < obj->materialCount; i++) {
         if (strcmp(material, obj->materials[i]) == 0) {
             obj->currentMaterial = i;
             return STATUS_OK;
         }
     }
 
-    char *temp = strCopy(material);
-    if(temp == NULL) return STATUS_ALLOC_ERR;
-
-    char **tempMtls = (char**)realloc(
+    char **tempMtls = (char**)reserve(
         obj->materials,
-        (obj->materialCount + 1) * sizeof(char*));
-    if(tempMtls == NULL) {
-        free(temp);
-        return STATUS_ALLOC_ERR;
-    }
-    obj->currentMaterial = obj->materialCount;
+        &obj->materialCapacity,
+        obj->materialCount,
+        sizeof(char*));
+    if(tempMtls == NULL) return STATUS_ALLOC_ERR;
     obj->materials = tempMtls;
-    obj->materials[obj->materialCount++] = temp;
+    if(copyName(obj->materials + obj->materialCount, material)) return STATUS_ALLOC_ERR;
+    obj->currentMaterial = obj->materialCount++;
 
     return STATUS_OK;
 }
@@ -171,25 +279,84 @@ int wavefrontObjectAddMaterial(
 int wavefrontObjectAddObject(
       struct WavefrontObject *obj,
       const char *name) {
-    char *temp = strCopy(name);
-    if(temp == NULL) {
-        return STATUS_ALLOC_ERR;
-    }
-
     struct WavefrontObjectObject *tempObj;
-    tempObj = (struct WavefrontObjectObject*)realloc(
+    tempObj = (struct WavefrontObjectObject*)reserve(
         obj->objects,
-        (obj->objectCount + 1) * sizeof(struct WavefrontObjectObject));
-    if (tempObj == NULL) {
-        free(temp);
-        return STATUS_ALLOC_ERR;
-    }
+        &obj->objectCapacity,
+        obj->objectCount,
+        sizeof(struct WavefrontObjectObject));
+    if (tempObj == NULL) return STATUS_ALLOC_ERR;
     obj->objects = tempObj;
 
+    // A reused slot keeps its faces buffer, emptied by wavefrontObjectReset.
+    struct WavefrontObjectObject *o = obj->objects + obj->objectCount;
+    if(copyName(&o->name, name)) return STATUS_ALLOC_ERR;
     obj->currentObject = obj->objectCount++;
-    struct WavefrontObjectObject *o = obj->objects + obj->currentObject;
-    o->name = temp;
-    o->faces = NULL;
-    o->faceCount = 0;
     return STATUS_OK;
+}
+
+// Whether every count and index fits the 32 bit types the derived modules
+// (bvh, quantize, reorder, simplify) work with. Always true without COBJ_LARGE.
+int wavefrontObjectFitsCompact(const struct WavefrontObject *obj) {
+#ifdef COBJ_LARGE
+    if(obj->vertexCount > INT_MAX || obj->unwrapCount > INT_MAX || obj->normalCount > INT_MAX
+            || obj->objectCount > INT_MAX || obj->materialCount > INT_MAX) {
+        return 0;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        if(o->faceCount > INT_MAX) return 0;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            if(face->pointCount > INT_MAX) return 0;
+            for(WavefrontObjectCount k = 0; k < face->pointCount; k++) {
+                const struct WavefrontObjectPoint *point = face->points + k;
+                if(point->v < INT_MIN || point->v > INT_MAX || point->vt < INT_MIN
+                        || point->vt > INT_MAX || point->vn < INT_MIN || point->vn > INT_MAX) {
+                    return 0;
+                }
+            }
+        }
+    }
+#endif
+    return 1;
+}
+
+static int bytesEqual(const void *a, const void *b, size_t size) {
+    return size == 0 || memcmp(a, b, size) == 0;
+}
+
+// Field by field equality, capacities aside. Coordinates compare bitwise so
+// parsed NaNs match themselves.
+int wavefrontObjectEqual(const struct WavefrontObject *a, const struct WavefrontObject *b) {
+    if(a->materialLibraryCount != b->materialLibraryCount || a->vertexCount != b->vertexCount
+            || a->unwrapCount != b->unwrapCount || a->normalCount != b->normalCount
+            || a->objectCount != b->objectCount || a->materialCount != b->materialCount
+            || a->currentMaterial != b->currentMaterial || a->currentObject != b->currentObject) {
+        return 0;
+    }
+    if(!bytesEqual(a->vertices, b->vertices, a->vertexCount * sizeof(struct WavefrontObjectVertex))
+            || !bytesEqual(a->unwraps, b->unwraps, a->unwrapCount * sizeof(struct WavefrontObjectUnwrap))
+            || !bytesEqual(a->normals, b->normals, a->normalCount * sizeof(struct WavefrontObjectNormal))) {
+        return 0;
+    }
+    for(WavefrontObjectCount i = 0; i < a->materialLibraryCount; i++) {
+        if(strcmp(a->materialLibraries[i], b->materialLibraries[i])) return 0;
+    }
+    for(WavefrontObjectCount i = 0; i < a->materialCount; i++) {
+        if(strcmp(a->materials[i], b->materials[i])) return 0;
+    }
+    for(WavefrontObjectCount i = 0; i < a->objectCount; i++) {
+        const struct WavefrontObjectObject *oa = a->objects + i, *ob = b->objects + i;
+        if(strcmp(oa->name, ob->name) || oa->faceCount != ob->faceCount) return 0;
+        for(WavefrontObjectCount j = 0; j < oa->faceCount; j++) {
+            const struct WavefrontObjectFace *fa = oa->faces + j, *fb = ob->faces + j;
+            if(fa->material != fb->material || fa->pointCount != fb->pointCount) return 0;
+            for(WavefrontObjectCount k = 0; k < fa->pointCount; k++) {
+                const struct WavefrontObjectPoint *pa = fa->points + k, *pb = fb->points + k;
+                if(pa->v != pb->v || pa->vt != pb->vt || pa->vn != pb->vn) return 0;
+            }
+        }
+    }
+    return 1;
 }
\ No newline at end of file
@@ -4,6 +4,21 @@
 extern "C"{
 #endif
 
+#include <limits.h>
+#include <stddef.h>
+
+// Counts and indices stay 32 bit unless built with COBJ_LARGE, which lifts
+// the limit from 2^31 - 1 elements to 2^63 - 1 at the cost of wider faces.
+#ifdef COBJ_LARGE
+typedef size_t WavefrontObjectCount;
+typedef long long WavefrontObjectIndex;
+#define WAVEFRONT_OBJECT_COUNT_MAX LLONG_MAX
+#else
+typedef unsigned int WavefrontObjectCount;
+typedef int WavefrontObjectIndex;
+#define WAVEFRONT_OBJECT_COUNT_MAX INT_MAX
+#endif
+
 struct WavefrontObjectVertex {
     double w, x, y, z;
 };
@@ -17,19 +32,22 @@ struct WavefrontObjectNormal {
 };
 
 struct WavefrontObjectPoint {
-    int v, vt, vn;
+    WavefrontObjectIndex v, vt, vn;
 };
 
 struct WavefrontObjectFace {
     struct WavefrontObjectPoint *points;
-    unsigned int pointCount;
-    unsigned int material;
+    WavefrontObjectCount pointCount;
+    WavefrontObjectCount material;
+    // Allocated points, only read for slots from wavefrontObjectNextFace.
+    WavefrontObjectCount pointCapacity;
 };
 
 struct WavefrontObjectObject {
     char *name;
     struct WavefrontObjectFace *faces;
-    unsigned int faceCount;
+    WavefrontObjectCount faceCount;
+    WavefrontObjectCount faceCapacity;
 };
 
 struct WavefrontObject {
@@ -39,20 +57,30 @@ struct WavefrontObject {
     struct WavefrontObjectVertex *vertices;
     struct WavefrontObjectUnwrap *unwraps;
     struct WavefrontObjectNormal *normals;
-    unsigned int materialLibraryCount;
-    unsigned int vertexCount;
-    unsigned int unwrapCount;
-    unsigned int normalCount;
-    unsigned int objectCount;
-    unsigned int materialCount;
-    int currentMaterial;
-    int currentObject;
+    WavefrontObjectCount materialLibraryCount;
+    WavefrontObjectCount vertexCount;
+    WavefrontObjectCount unwrapCount;
+    WavefrontObjectCount normalCount;
+    WavefrontObjectCount objectCount;
+    WavefrontObjectCount materialCount;
+    WavefrontObjectIndex currentMaterial;
+    WavefrontObjectIndex currentObject;
+    // Allocated slots, those past the counts keep their buffers for reuse.
+    WavefrontObjectCount materialLibraryCapacity;
+    WavefrontObjectCount vertexCapacity;
+    WavefrontObjectCount unwrapCapacity;
+    WavefrontObjectCount normalCapacity;
+    WavefrontObjectCount objectCapacity;
+    WavefrontObjectCount materialCapacity;
 };
 
 int wavefrontObjectCompose(struct WavefrontObject *obj);
 int wavefrontObjectFaceAddPoint(struct WavefrontObjectFace *face, struct WavefrontObjectPoint *point);
+int wavefrontObjectFaceSetPoints(struct WavefrontObjectFace *face, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount);
 void wavefrontObjectFaceFree(struct WavefrontObjectFace *face);
 void wavefrontObjectRelease(struct WavefrontObject *obj);
+void wavefrontObjectReset(struct WavefrontObject *obj);
+struct WavefrontObjectFace *wavefrontObjectNextFace(struct WavefrontObject *obj);
 int wavefrontObjectAddVertex(struct WavefrontObject *obj, struct WavefrontObjectVertex *vertex);
 int wavefrontObjectAddUnwrap(struct WavefrontObject *obj, struct WavefrontObjectUnwrap *unwrap);
 int wavefrontObjectAddNormal(struct WavefrontObject *obj, struct WavefrontObjectNormal *normal);
@@ -60,6 +88,8 @@ int wavefrontObjectAddFace(struct WavefrontObject *obj, struct WavefrontObjectFa
 int wavefrontObjectAddMaterialLibrary(struct WavefrontObject *obj, const char *materialLibrary);
 int wavefrontObjectAddMaterial(struct WavefrontObject *obj, const char *material);
 int wavefrontObjectAddObject(struct WavefrontObject *obj, const char *object);
+int wavefrontObjectFitsCompact(const struct WavefrontObject *obj);
+int wavefrontObjectEqual(const struct WavefrontObject *a, const struct WavefrontObject *b);
 
 #ifdef __cplusplus
 }
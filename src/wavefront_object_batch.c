@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "cutil/src/error.h"
+#include "wavefront_object_parser.h"
+#include "wavefront_object_stream.h"
+#include "wavefront_object_batch.h"
+
+// Inputs begin..end-1 are still queued on a worker. The owner pops from the
+// front and idle workers steal the back half.
+struct BatchQueue {
+    pthread_mutex_t mutex;
+    unsigned int begin, end;
+};
+
+struct BatchPool {
+    struct BatchQueue *queues;
+    unsigned int threadCount;
+    struct WavefrontObject *objs;
+    int *statuses;
+    const char *const *inputs;
+    int files;
+};
+
+struct BatchWorker {
+    struct BatchPool *pool;
+    unsigned int index;
+};
+
+static int popInput(struct BatchPool *pool, unsigned int index, unsigned int *input) {
+    struct BatchQueue *own = pool->queues + index;
+    pthread_mutex_lock(&own->mutex);
+    int found = own->begin < own->end;
+    if(found) *input = own->begin++;
+    pthread_mutex_unlock(&own->mutex);
+    if(found) return 1;
+
+    for(unsigned int i = 1; i < pool->threadCount; i++) {
+        struct BatchQueue *victim = pool->queues + (index + i) % pool->threadCount;
+        pthread_mutex_lock(&victim->mutex);
+        unsigned int remaining = victim->end - victim->begin;
+        unsigned int begin = victim->end - (remaining + 1) / 2, end = victim->end;
+        victim->end = begin;
+        pthread_mutex_unlock(&victim->mutex);
+        if(remaining == 0) continue;
+        // Nobody steals from an empty queue, so the own queue is still ours to refill.
+        pthread_mutex_lock(&own->mutex);
+        own->begin = begin + 1;
+        own->end = end;
+        pthread_mutex_unlock(&own->mutex);
+        *input = begin;
+        return 1;
+    }
+    return 0;
+}
+
+static void *parseInputs(void *arg) {
+    struct BatchWorker *worker = (struct BatchWorker*)arg;
+    struct BatchPool *pool = worker->pool;
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    unsigned int input;
+    while(popInput(pool, worker->index, &input)) {
+        if(pool->files) {
+            pool->statuses[input] = wavefrontObjectParserParseFile(&parser, pool->objs + input, pool->inputs[input]);
+        } else {
+            pool->statuses[input] = wavefrontObjectParserParseString(&parser, pool->objs + input, pool->inputs[input]);
+        }
+    }
+    wavefrontObjectParserRelease(&parser);
+    return NULL;
+}
+
+static int parseBatch(
+        struct WavefrontObject *objs,
+        int *statuses,
+        const char *const *inputs,
+        unsigned int count,
+        unsigned int threadCount,
+        int files) {
+    if(count == 0) return STATUS_OK;
+    if(threadCount == 0) threadCount = 1;
+    if(threadCount > count) threadCount = count;
+
+    struct BatchPool pool = {NULL, threadCount, objs, statuses, inputs, files};
+    pool.queues = (struct BatchQueue*)malloc(threadCount * sizeof(struct BatchQueue));
+    struct BatchWorker *workers = (struct BatchWorker*)malloc(threadCount * sizeof(struct BatchWorker));
+    pthread_t *threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+    char *started = (char*)calloc(threadCount, 1);
+    int result = STATUS_ALLOC_ERR;
+    if(pool.queues && workers && threads && started) {
+        for(unsigned int i = 0; i < threadCount; i++) {
+            pthread_mutex_init(&pool.queues[i].mutex, NULL);
+            pool.queues[i].begin = (unsigned int)((unsigned long long)count * i / threadCount);
+            pool.queues[i].end = (unsigned int)((unsigned long long)count * (i + 1) / threadCount);
+            workers[i].pool = &pool;
+            workers[i].index = i;
+        }
+        // Queues of threads that fail to start are stolen by the others.
+        for(unsigned int i = 1; i < threadCount; i++) {
+            started[i] = pthread_create(threads + i, NULL, parseInputs, workers + i) == 0;
+        }
+        parseInputs(workers);
+        for(unsigned int i = 1; i < threadCount; i++) {
+            if(started[i]) pthread_join(threads[i], NULL);
+        }
+        for(unsigned int i = 0; i < threadCount; i++) pthread_mutex_destroy(&pool.queues[i].mutex);
+        result = STATUS_OK;
+    }
+    free(pool.queues);
+    free(workers);
+    free(threads);
+    free(started);
+    return result;
+}
+
+int wavefrontObjectBatchParseFiles(
+        struct WavefrontObject *objs,
+        int *statuses,
+        const char *const *paths,
+        unsigned int count,
+        unsigned int threadCount) {
+    return parseBatch(objs, statuses, paths, count, threadCount, 1);
+}
+
+int wavefrontObjectBatchParseStrings(
+        struct WavefrontObject *objs,
+        int *statuses,
+        const char *const *inputs,
+        unsigned int count,
+        unsigned int threadCount) {
+    return parseBatch(objs, statuses, inputs, count, threadCount, 0);
+}
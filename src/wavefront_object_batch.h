@@ -0,0 +1,19 @@
+#ifndef __WAVEFRONT_OBJECT_BATCH_H
+#define __WAVEFRONT_OBJECT_BATCH_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+
+// Parse count inputs on up to threadCount threads, the calling thread included.
+// statuses[i] receives the STATUS_* code of input i, for files including the
+// WAVEFRONT_OBJECT_STATUS_OPEN_ERR of wavefront_object_stream.h, and objs[i]
+// holds its object when that is STATUS_OK. The return value only reports pool setup.
+int wavefrontObjectBatchParseFiles(struct WavefrontObject *objs, int *statuses, const char *const *paths, unsigned int count, unsigned int threadCount);
+int wavefrontObjectBatchParseStrings(struct WavefrontObject *objs, int *statuses, const char *const *inputs, unsigned int count, unsigned int threadCount);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
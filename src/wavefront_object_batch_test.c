@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "wavefront_object_batch.h"
+#include "wavefront_object_stream.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+static const char *batchInputs[] = {
+    "o first\nv 1 2 3\nv 4 5 6\nv 7 8 9\nf 1 2 3\n",
+    "v 1 2\n",
+    "",
+    "o second\nv 0 0 0\nvn 0 0 1\nusemtl red\nf 1//1 1//1 1//1"};
+
+void batchParsesStrings() {
+    struct WavefrontObject wObjs[4];
+    int statuses[4];
+    int result = wavefrontObjectBatchParseStrings(wObjs, statuses, batchInputs, 4, 3);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(statuses[0], STATUS_OK);
+    assertIntegersEqual(statuses[1], STATUS_PARSE_ERR);
+    assertIntegersEqual(statuses[2], STATUS_OK);
+    assertIntegersEqual(statuses[3], STATUS_OK);
+    assertIntegersEqual(wObjs[0].vertexCount, 3);
+    assertStringsEqual(wObjs[0].objects->name, "first");
+    assertIntegersEqual(wObjs[2].vertexCount, 0);
+    assertIntegersEqual(wObjs[3].normalCount, 1);
+    assertIntegersEqual(wObjs[3].objects->faces->points[2].vn, 1);
+    for(int i = 0; i < 4; i++) {
+        if(statuses[i] == STATUS_OK) wavefrontObjectRelease(wObjs + i);
+    }
+}
+
+void batchStealsFromBusyWorkers() {
+    unsigned int count = 64;
+    const char **inputs = (const char**)malloc(count * sizeof(char*));
+    struct WavefrontObject *wObjs = (struct WavefrontObject*)malloc(count * sizeof(struct WavefrontObject));
+    int *statuses = (int*)malloc(count * sizeof(int));
+    // All the work sits in the first worker's queue.
+    unsigned int lineCount = 20000;
+    char *large = (char*)malloc(lineCount * 16);
+    unsigned long size = 0;
+    for(unsigned int i = 0; i < lineCount; i++) size += sprintf(large + size, "v %u 0 0\n", i);
+    for(unsigned int i = 0; i < count; i++) inputs[i] = i < count / 4 ? large : batchInputs[0];
+
+    int result = wavefrontObjectBatchParseStrings(wObjs, statuses, inputs, count, 4);
+    assertIntegersEqual(result, STATUS_OK);
+    int parsed = 0;
+    for(unsigned int i = 0; i < count; i++) {
+        unsigned int expected = i < count / 4 ? lineCount : 3;
+        parsed += statuses[i] == STATUS_OK && wObjs[i].vertexCount == expected;
+        if(statuses[i] == STATUS_OK) wavefrontObjectRelease(wObjs + i);
+    }
+    assertIntegersEqual(parsed, count);
+    free(large);
+    free(inputs);
+    free(wObjs);
+    free(statuses);
+}
+
+void batchParsesFiles() {
+    const char *paths[] = {"bin/batch_test_0.obj", "bin/batch_test_missing.obj", "bin/batch_test_1.obj"};
+    FILE *file = fopen(paths[0], "wb");
+    fputs(batchInputs[0], file);
+    fclose(file);
+    file = fopen(paths[2], "wb");
+    fputs(batchInputs[3], file);
+    fclose(file);
+
+    struct WavefrontObject wObjs[3];
+    int statuses[3];
+    int result = wavefrontObjectBatchParseFiles(wObjs, statuses, paths, 3, 2);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(statuses[0], STATUS_OK);
+    assertIntegersEqual(statuses[1], WAVEFRONT_OBJECT_STATUS_OPEN_ERR);
+    assertIntegersEqual(statuses[2], STATUS_OK);
+    assertIntegersEqual(wObjs[0].objects->faceCount, 1);
+    assertStringsEqual(wObjs[2].objects->name, "second");
+    wavefrontObjectRelease(wObjs);
+    wavefrontObjectRelease(wObjs + 2);
+    remove(paths[0]);
+    remove(paths[2]);
+}
+
+void wavefrontObjectBatchTest() {
+    batchParsesStrings();
+    batchStealsFromBusyWorkers();
+    batchParsesFiles();
+}
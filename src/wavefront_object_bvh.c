@@ -0,0 +1,597 @@
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_bvh.h"
+
+#define BVH_BIN_COUNT 16
+#define BVH_LEAF_SIZE 4
+#define BVH_MAX_DEPTH 60
+#define BVH_STACK_SIZE 64
+#define BVH_PARALLEL_SIZE 4096
+#define BVH_MAX_THREADS 64
+// Node offsets are 32 bit and a tree over n triangles has 2n - 1 nodes.
+#define BVH_MAX_TRIANGLES (UINT_MAX / 2)
+
+struct BvhPrimitive {
+    double min[3], max[3], centroid[3];
+};
+
+struct BvhBuild {
+    struct BvhPrimitive *primitives;
+    unsigned int *indices;
+};
+
+struct BvhNodeList {
+    struct WavefrontObjectBvhNode *nodes;
+    unsigned int count;
+};
+
+struct BvhTask {
+    struct BvhBuild *build;
+    struct BvhNodeList list;
+    unsigned int begin, end, depth, parallelDepth;
+    int result;
+};
+
+// malloc of count elements, NULL when the byte size would wrap.
+static void *allocArray(size_t count, size_t size) {
+    if(count > (size_t)-1 / size) return NULL;
+    return malloc(count * size);
+}
+
+// Threads worth starting, the cores online where the platform says and never
+// more than BVH_MAX_THREADS.
+static unsigned int usableThreads(unsigned int threadCount) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cores > 0 && (unsigned long)cores < threadCount) threadCount = (unsigned int)cores;
+#endif
+    return threadCount > BVH_MAX_THREADS ? BVH_MAX_THREADS : threadCount;
+}
+
+static void boundsReset(double min[3], double max[3]) {
+    for(int i = 0; i < 3; i++) {
+        min[i] = HUGE_VAL;
+        max[i] = -HUGE_VAL;
+    }
+}
+
+static void boundsGrow(double min[3], double max[3], const double pMin[3], const double pMax[3]) {
+    for(int i = 0; i < 3; i++) {
+        if(pMin[i] < min[i]) min[i] = pMin[i];
+        if(pMax[i] > max[i]) max[i] = pMax[i];
+    }
+}
+
+static double boundsArea(const double min[3], const double max[3]) {
+    double x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+    if(x < 0 || y < 0 || z < 0) return 0;
+    return x*y + y*z + z*x;
+}
+
+static void vertexPosition(const struct WavefrontObject *obj, unsigned int index, double position[3]) {
+    const struct WavefrontObjectVertex *vertex = obj->vertices + index;
+    position[0] = vertex->x;
+    position[1] = vertex->y;
+    position[2] = vertex->z;
+}
+
+static void trianglePositions(
+        const struct WavefrontObject *obj,
+        const struct WavefrontObjectBvhTriangle *tri,
+        double positions[3][3]) {
+    for(int i = 0; i < 3; i++) vertexPosition(obj, tri->vertices[i], positions[i]);
+}
+
+// Faces with a NaN or infinite corner have no bounds to bin, they are left out.
+static int faceIsValid(const struct WavefrontObject *obj, const struct WavefrontObjectFace *face) {
+    if(face->pointCount < 3) return 0;
+    for(unsigned int i = 0; i < face->pointCount; i++) {
+        int v = face->points[i].v;
+        if(v < 1 || (unsigned int)v > obj->vertexCount) return 0;
+        const struct WavefrontObjectVertex *vertex = obj->vertices + v - 1;
+        if(!isfinite(vertex->x) || !isfinite(vertex->y) || !isfinite(vertex->z)) return 0;
+    }
+    return 1;
+}
+
+// The bin of a centroid, clamped so rounding at either end stays in range.
+static int centroidBin(double offset, double scale) {
+    double bin = offset * scale;
+    if(!(bin > 0)) return 0;
+    if(bin >= BVH_BIN_COUNT - 1) return BVH_BIN_COUNT - 1;
+    return (int)bin;
+}
+
+// Partition indices[begin, end) around a split plane, returning 0 when the range should become a leaf.
+static int splitRange(struct BvhBuild *b, unsigned int begin, unsigned int end, unsigned int *mid) {
+    double cMin[3], cMax[3];
+    boundsReset(cMin, cMax);
+    for(unsigned int i = begin; i < end; i++) {
+        const double *c = b->primitives[b->indices[i]].centroid;
+        boundsGrow(cMin, cMax, c, c);
+    }
+    int axis = 0;
+    for(int i = 1; i < 3; i++) {
+        if(cMax[i] - cMin[i] > cMax[axis] - cMin[axis]) axis = i;
+    }
+    double extent = cMax[axis] - cMin[axis];
+    unsigned int count = end - begin;
+    if(extent <= 0) {
+        // Every centroid coincides, no plane separates them.
+        if(count <= BVH_LEAF_SIZE) return 0;
+        *mid = begin + count / 2;
+        return 1;
+    }
+
+    unsigned int binCounts[BVH_BIN_COUNT] = {0};
+    double binMin[BVH_BIN_COUNT][3], binMax[BVH_BIN_COUNT][3];
+    for(int i = 0; i < BVH_BIN_COUNT; i++) boundsReset(binMin[i], binMax[i]);
+    double scale = BVH_BIN_COUNT / extent;
+    for(unsigned int i = begin; i < end; i++) {
+        const struct BvhPrimitive *p = b->primitives + b->indices[i];
+        int bin = centroidBin(p->centroid[axis] - cMin[axis], scale);
+        binCounts[bin]++;
+        boundsGrow(binMin[bin], binMax[bin], p->min, p->max);
+    }
+
+    // Sweep from the right to get the cost of every right hand side.
+    double rightArea[BVH_BIN_COUNT];
+    unsigned int rightCount[BVH_BIN_COUNT];
+    double min[3], max[3];
+    boundsReset(min, max);
+    unsigned int running = 0;
+    for(int i = BVH_BIN_COUNT - 1; i > 0; i--) {
+        boundsGrow(min, max, binMin[i], binMax[i]);
+        running += binCounts[i];
+        rightArea[i] = boundsArea(min, max);
+        rightCount[i] = running;
+    }
+    boundsReset(min, max);
+    running = 0;
+    int bestBin = -1;
+    double bestCost = HUGE_VAL;
+    for(int i = 0; i < BVH_BIN_COUNT - 1; i++) {
+        boundsGrow(min, max, binMin[i], binMax[i]);
+        running += binCounts[i];
+        if(running == 0 || rightCount[i + 1] == 0) continue;
+        double cost = boundsArea(min, max) * running + rightArea[i + 1] * rightCount[i + 1];
+        if(cost < bestCost) {
+            bestCost = cost;
+            bestBin = i;
+        }
+    }
+    double leafCost = 0;
+    for(int i = 0; i < BVH_BIN_COUNT; i++) {
+        leafCost += binCounts[i];
+    }
+    boundsReset(min, max);
+    for(int i = 0; i < BVH_BIN_COUNT; i++) boundsGrow(min, max, binMin[i], binMax[i]);
+    leafCost *= boundsArea(min, max);
+    if(bestBin < 0 || (count <= BVH_LEAF_SIZE && bestCost >= leafCost)) return 0;
+
+    unsigned int left = begin, right = end;
+    while(left < right) {
+        const struct BvhPrimitive *p = b->primitives + b->indices[left];
+        int bin = centroidBin(p->centroid[axis] - cMin[axis], scale);
+        if(bin <= bestBin) {
+            left++;
+        } else {
+            unsigned int temp = b->indices[left];
+            b->indices[left] = b->indices[--right];
+            b->indices[right] = temp;
+        }
+    }
+    if(left == begin || left == end) left = begin + count / 2;
+    *mid = left;
+    return 1;
+}
+
+static void rangeBounds(struct BvhBuild *b, unsigned int begin, unsigned int end, struct WavefrontObjectBvhNode *node) {
+    boundsReset(node->min, node->max);
+    for(unsigned int i = begin; i < end; i++) {
+        const struct BvhPrimitive *p = b->primitives + b->indices[i];
+        boundsGrow(node->min, node->max, p->min, p->max);
+    }
+}
+
+static unsigned int buildRange(struct BvhBuild *b, struct BvhNodeList *list, unsigned int begin, unsigned int end, unsigned int depth) {
+    unsigned int nodeIndex = list->count++;
+    struct WavefrontObjectBvhNode node;
+    rangeBounds(b, begin, end, &node);
+    unsigned int mid;
+    if(depth >= BVH_MAX_DEPTH || !splitRange(b, begin, end, &mid)) {
+        node.offset = begin;
+        node.count = end - begin;
+    } else {
+        buildRange(b, list, begin, mid, depth + 1);
+        node.offset = buildRange(b, list, mid, end, depth + 1);
+        node.count = 0;
+    }
+    list->nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+// Append a subtree built in its own list, rebasing its interior nodes.
+static void appendNodes(struct BvhNodeList *list, const struct BvhNodeList *subtree) {
+    unsigned int base = list->count;
+    for(unsigned int i = 0; i < subtree->count; i++) {
+        struct WavefrontObjectBvhNode node = subtree->nodes[i];
+        if(node.count == 0) node.offset += base;
+        list->nodes[list->count++] = node;
+    }
+}
+
+static void *buildTask(void *arg);
+
+static int buildParallel(struct BvhTask *task) {
+    struct BvhBuild *b = task->build;
+    unsigned int count = task->end - task->begin;
+    task->list.count = 0;
+    task->list.nodes = (struct WavefrontObjectBvhNode*)allocArray(
+        2 * (size_t)count - 1, sizeof(struct WavefrontObjectBvhNode));
+    if(task->list.nodes == NULL) return STATUS_ALLOC_ERR;
+
+    unsigned int mid;
+    if(task->parallelDepth == 0 || count < BVH_PARALLEL_SIZE) {
+        buildRange(b, &task->list, task->begin, task->end, task->depth);
+        return STATUS_OK;
+    }
+    struct WavefrontObjectBvhNode node;
+    rangeBounds(b, task->begin, task->end, &node);
+    if(task->depth >= BVH_MAX_DEPTH || !splitRange(b, task->begin, task->end, &mid)) {
+        node.offset = task->begin;
+        node.count = count;
+        task->list.nodes[task->list.count++] = node;
+        return STATUS_OK;
+    }
+
+    struct BvhTask left = {b, {NULL, 0}, task->begin, mid, task->depth + 1, task->parallelDepth - 1, STATUS_OK};
+    struct BvhTask right = {b, {NULL, 0}, mid, task->end, task->depth + 1, task->parallelDepth - 1, STATUS_OK};
+    pthread_t thread;
+    int threaded = pthread_create(&thread, NULL, buildTask, &left) == 0;
+    if(!threaded) buildTask(&left);
+    buildTask(&right);
+    if(threaded) pthread_join(thread, NULL);
+
+    int result = left.result ? left.result : right.result;
+    if(result == STATUS_OK) {
+        node.count = 0;
+        node.offset = 1 + left.list.count;
+        task->list.nodes[task->list.count++] = node;
+        appendNodes(&task->list, &left.list);
+        appendNodes(&task->list, &right.list);
+    }
+    free(left.list.nodes);
+    free(right.list.nodes);
+    return result;
+}
+
+static void *buildTask(void *arg) {
+    struct BvhTask *task = (struct BvhTask*)arg;
+    task->result = buildParallel(task);
+    return NULL;
+}
+
+int wavefrontObjectBvhCompose(struct WavefrontObjectBvh *bvh) {
+    memset(bvh, 0, sizeof(struct WavefrontObjectBvh));
+    return STATUS_OK;
+}
+
+int wavefrontObjectBvhBuild(
+        struct WavefrontObjectBvh *bvh,
+        const struct WavefrontObject *obj,
+        unsigned int threadCount) {
+    wavefrontObjectBvhCompose(bvh);
+    if(!wavefrontObjectFitsCompact(obj)) return STATUS_ALLOC_ERR;
+
+    // Faces fit 32 bits but their triangles together may not, refuse those.
+    unsigned long long total = 0;
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            if(faceIsValid(obj, o->faces + j)) total += o->faces[j].pointCount - 2;
+            if(total > BVH_MAX_TRIANGLES) return STATUS_ALLOC_ERR;
+        }
+    }
+    unsigned int triangleCount = (unsigned int)total;
+    if(triangleCount == 0) return STATUS_OK;
+
+    struct WavefrontObjectBvhTriangle *triangles = (struct WavefrontObjectBvhTriangle*)allocArray(
+        triangleCount, sizeof(struct WavefrontObjectBvhTriangle));
+    struct BvhBuild b;
+    b.primitives = (struct BvhPrimitive*)allocArray(triangleCount, sizeof(struct BvhPrimitive));
+    b.indices = (unsigned int*)allocArray(triangleCount, sizeof(unsigned int));
+    if(triangles == NULL || b.primitives == NULL || b.indices == NULL) {
+        free(triangles);
+        free(b.primitives);
+        free(b.indices);
+        return STATUS_ALLOC_ERR;
+    }
+
+    unsigned int t = 0;
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            if(!faceIsValid(obj, face)) continue;
+            // Fan triangulate polygons around their first point.
+            for(unsigned int k = 2; k < face->pointCount; k++, t++) {
+                struct WavefrontObjectBvhTriangle *tri = triangles + t;
+                tri->vertices[0] = face->points[0].v - 1;
+                tri->vertices[1] = face->points[k - 1].v - 1;
+                tri->vertices[2] = face->points[k].v - 1;
+                tri->object = i;
+                tri->face = j;
+
+                struct BvhPrimitive *p = b.primitives + t;
+                boundsReset(p->min, p->max);
+                double positions[3][3];
+                trianglePositions(obj, tri, positions);
+                for(int c = 0; c < 3; c++) boundsGrow(p->min, p->max, positions[c], positions[c]);
+                for(int c = 0; c < 3; c++) p->centroid[c] = (p->min[c] + p->max[c]) * 0.5;
+                b.indices[t] = t;
+            }
+        }
+    }
+
+    // Each split below parallelDepth starts one thread, so 2^depth threads at most.
+    unsigned int parallelDepth = 0;
+    threadCount = usableThreads(threadCount);
+    while(threadCount > 1u << parallelDepth) parallelDepth++;
+    struct BvhTask root = {&b, {NULL, 0}, 0, triangleCount, 0, parallelDepth, STATUS_OK};
+    int result = buildParallel(&root);
+
+    // Store triangles in leaf order so every leaf references a contiguous run.
+    struct WavefrontObjectBvhTriangle *ordered = NULL;
+    if(result == STATUS_OK) {
+        ordered = (struct WavefrontObjectBvhTriangle*)allocArray(
+            triangleCount, sizeof(struct WavefrontObjectBvhTriangle));
+        if(ordered == NULL) result = STATUS_ALLOC_ERR;
+    }
+    if(result == STATUS_OK) {
+        for(unsigned int i = 0; i < triangleCount; i++) {
+            ordered[i] = triangles[b.indices[i]];
+        }
+        struct WavefrontObjectBvhNode *nodes = (struct WavefrontObjectBvhNode*)realloc(
+            root.list.nodes,
+            root.list.count * sizeof(struct WavefrontObjectBvhNode));
+        bvh->nodes = nodes ? nodes : root.list.nodes;
+        bvh->nodeCount = root.list.count;
+        bvh->triangles = ordered;
+        bvh->triangleCount = triangleCount;
+    } else {
+        free(root.list.nodes);
+    }
+    free(triangles);
+    free(b.primitives);
+    free(b.indices);
+    return result;
+}
+
+void wavefrontObjectBvhRelease(struct WavefrontObjectBvh *bvh) {
+    free(bvh->nodes);
+    free(bvh->triangles);
+}
+
+static int rayBoxDistance(
+        const struct WavefrontObjectBvhNode *node,
+        const double origin[3],
+        const double inverse[3],
+        double maxDistance,
+        double *distance) {
+    double near = 0, far = maxDistance;
+    for(int i = 0; i < 3; i++) {
+        double t0 = (node->min[i] - origin[i]) * inverse[i];
+        double t1 = (node->max[i] - origin[i]) * inverse[i];
+        if(t0 > t1) {
+            double temp = t0;
+            t0 = t1;
+            t1 = temp;
+        }
+        if(t0 > near) near = t0;
+        if(t1 < far) far = t1;
+        if(near > far) return 0;
+    }
+    *distance = near;
+    return 1;
+}
+
+// Moller-Trumbore ray triangle intersection.
+static int rayTriangle(
+        const double origin[3],
+        const double direction[3],
+        const double a[3], const double b[3], const double c[3],
+        double *t, double *u, double *v) {
+    double e1[3], e2[3], p[3], q[3], s[3];
+    for(int i = 0; i < 3; i++) {
+        e1[i] = b[i] - a[i];
+        e2[i] = c[i] - a[i];
+        s[i] = origin[i] - a[i];
+    }
+    p[0] = direction[1]*e2[2] - direction[2]*e2[1];
+    p[1] = direction[2]*e2[0] - direction[0]*e2[2];
+    p[2] = direction[0]*e2[1] - direction[1]*e2[0];
+    double det = e1[0]*p[0] + e1[1]*p[1] + e1[2]*p[2];
+    if(det == 0) return 0;
+    double inverse = 1.0 / det;
+    *u = (s[0]*p[0] + s[1]*p[1] + s[2]*p[2]) * inverse;
+    if(*u < 0 || *u > 1) return 0;
+    q[0] = s[1]*e1[2] - s[2]*e1[1];
+    q[1] = s[2]*e1[0] - s[0]*e1[2];
+    q[2] = s[0]*e1[1] - s[1]*e1[0];
+    *v = (direction[0]*q[0] + direction[1]*q[1] + direction[2]*q[2]) * inverse;
+    if(*v < 0 || *u + *v > 1) return 0;
+    *t = (e2[0]*q[0] + e2[1]*q[1] + e2[2]*q[2]) * inverse;
+    return *t >= 0;
+}
+
+int wavefrontObjectBvhIntersectRay(
+        const struct WavefrontObjectBvh *bvh,
+        const struct WavefrontObject *obj,
+        const double origin[3],
+        const double direction[3],
+        double maxDistance,
+        struct WavefrontObjectBvhHit *hit) {
+    if(bvh->nodeCount == 0) return 0;
+    double inverse[3];
+    for(int i = 0; i < 3; i++) inverse[i] = 1.0 / direction[i];
+
+    int found = 0;
+    double closest = maxDistance, distance;
+    unsigned int stack[BVH_STACK_SIZE];
+    unsigned int stackCount = 0;
+    if(rayBoxDistance(bvh->nodes, origin, inverse, closest, &distance)) stack[stackCount++] = 0;
+    while(stackCount) {
+        const struct WavefrontObjectBvhNode *node = bvh->nodes + stack[--stackCount];
+        if(node->count) {
+            for(unsigned int i = node->offset; i < node->offset + node->count; i++) {
+                const struct WavefrontObjectBvhTriangle *tri = bvh->triangles + i;
+                double positions[3][3], t, u, v;
+                trianglePositions(obj, tri, positions);
+                if(rayTriangle(origin, direction, positions[0], positions[1], positions[2], &t, &u, &v)
+                        && t <= closest) {
+                    closest = t;
+                    found = 1;
+                    hit->t = t;
+                    hit->u = u;
+                    hit->v = v;
+                    hit->triangle = i;
+                    hit->object = tri->object;
+                    hit->face = tri->face;
+                }
+            }
+            continue;
+        }
+        // Visit the nearer child first by pushing it last.
+        unsigned int left = node - bvh->nodes + 1, right = node->offset;
+        double leftDistance, rightDistance;
+        int hitLeft = rayBoxDistance(bvh->nodes + left, origin, inverse, closest, &leftDistance);
+        int hitRight = rayBoxDistance(bvh->nodes + right, origin, inverse, closest, &rightDistance);
+        if(hitLeft && hitRight) {
+            if(leftDistance < rightDistance) {
+                stack[stackCount++] = right;
+                stack[stackCount++] = left;
+            } else {
+                stack[stackCount++] = left;
+                stack[stackCount++] = right;
+            }
+        }
+        else if(hitLeft) stack[stackCount++] = left;
+        else if(hitRight) stack[stackCount++] = right;
+    }
+    return found;
+}
+
+static double pointBoxDistanceSquared(const struct WavefrontObjectBvhNode *node, const double point[3]) {
+    double distance = 0;
+    for(int i = 0; i < 3; i++) {
+        double d = 0;
+        if(point[i] < node->min[i]) d = node->min[i] - point[i];
+        else if(point[i] > node->max[i]) d = point[i] - node->max[i];
+        distance += d*d;
+    }
+    return distance;
+}
+
+static double dot(const double a[3], const double b[3]) {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+// Closest point on a triangle from Ericson, Real-Time Collision Detection 5.1.5.
+static void closestPointTriangle(const double p[3], const double a[3], const double b[3], const double c[3], double result[3]) {
+    double ab[3], ac[3], ap[3], bp[3], cp[3];
+    for(int i = 0; i < 3; i++) {
+        ab[i] = b[i] - a[i];
+        ac[i] = c[i] - a[i];
+        ap[i] = p[i] - a[i];
+        bp[i] = p[i] - b[i];
+        cp[i] = p[i] - c[i];
+    }
+    double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if(d1 <= 0 && d2 <= 0) {
+        for(int i = 0; i < 3; i++) result[i] = a[i];
+        return;
+    }
+    double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if(d3 >= 0 && d4 <= d3) {
+        for(int i = 0; i < 3; i++) result[i] = b[i];
+        return;
+    }
+    double vc = d1*d4 - d3*d2;
+    if(vc <= 0 && d1 >= 0 && d3 <= 0) {
+        double v = d1 / (d1 - d3);
+        for(int i = 0; i < 3; i++) result[i] = a[i] + v*ab[i];
+        return;
+    }
+    double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if(d6 >= 0 && d5 <= d6) {
+        for(int i = 0; i < 3; i++) result[i] = c[i];
+        return;
+    }
+    double vb = d5*d2 - d1*d6;
+    if(vb <= 0 && d2 >= 0 && d6 <= 0) {
+        double w = d2 / (d2 - d6);
+        for(int i = 0; i < 3; i++) result[i] = a[i] + w*ac[i];
+        return;
+    }
+    double va = d3*d6 - d5*d4;
+    if(va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        for(int i = 0; i < 3; i++) result[i] = b[i] + w*(c[i] - b[i]);
+        return;
+    }
+    double denom = 1.0 / (va + vb + vc);
+    double v = vb * denom, w = vc * denom;
+    for(int i = 0; i < 3; i++) result[i] = a[i] + ab[i]*v + ac[i]*w;
+}
+
+int wavefrontObjectBvhNearestPoint(
+        const struct WavefrontObjectBvh *bvh,
+        const struct WavefrontObject *obj,
+        const double point[3],
+        struct WavefrontObjectBvhNearest *nearest) {
+    if(bvh->nodeCount == 0) return 0;
+
+    double closest = HUGE_VAL;
+    unsigned int stack[BVH_STACK_SIZE];
+    unsigned int stackCount = 0;
+    stack[stackCount++] = 0;
+    while(stackCount) {
+        const struct WavefrontObjectBvhNode *node = bvh->nodes + stack[--stackCount];
+        if(pointBoxDistanceSquared(node, point) >= closest) continue;
+        if(node->count) {
+            for(unsigned int i = node->offset; i < node->offset + node->count; i++) {
+                const struct WavefrontObjectBvhTriangle *tri = bvh->triangles + i;
+                double positions[3][3], candidate[3], delta[3];
+                trianglePositions(obj, tri, positions);
+                closestPointTriangle(point, positions[0], positions[1], positions[2], candidate);
+                for(int c = 0; c < 3; c++) delta[c] = candidate[c] - point[c];
+                double distance = dot(delta, delta);
+                if(distance < closest) {
+                    closest = distance;
+                    for(int c = 0; c < 3; c++) nearest->point[c] = candidate[c];
+                    nearest->triangle = i;
+                    nearest->object = tri->object;
+                    nearest->face = tri->face;
+                }
+            }
+            continue;
+        }
+        unsigned int left = node - bvh->nodes + 1, right = node->offset;
+        double leftDistance = pointBoxDistanceSquared(bvh->nodes + left, point);
+        double rightDistance = pointBoxDistanceSquared(bvh->nodes + right, point);
+        if(leftDistance < rightDistance) {
+            stack[stackCount++] = right;
+            stack[stackCount++] = left;
+        } else {
+            stack[stackCount++] = left;
+            stack[stackCount++] = right;
+        }
+    }
+    nearest->distance = sqrt(closest);
+    return 1;
+}
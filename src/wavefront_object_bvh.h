@@ -0,0 +1,56 @@
+#ifndef __WAVEFRONT_OBJECT_BVH_H
+#define __WAVEFRONT_OBJECT_BVH_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+
+// Nodes are stored depth first. An interior node's left child immediately
+// follows it, offset holds the index of its right child and count is zero.
+// A leaf holds count triangles starting at triangles[offset].
+struct WavefrontObjectBvhNode {
+    double min[3], max[3];
+    unsigned int offset;
+    unsigned int count;
+};
+
+// Zero based vertex indices of a triangle fanned out of objects[object].faces[face].
+struct WavefrontObjectBvhTriangle {
+    unsigned int vertices[3];
+    unsigned int object;
+    unsigned int face;
+};
+
+struct WavefrontObjectBvh {
+    struct WavefrontObjectBvhNode *nodes;
+    struct WavefrontObjectBvhTriangle *triangles;
+    unsigned int nodeCount;
+    unsigned int triangleCount;
+};
+
+struct WavefrontObjectBvhHit {
+    double t, u, v;
+    unsigned int triangle;
+    unsigned int object;
+    unsigned int face;
+};
+
+struct WavefrontObjectBvhNearest {
+    double point[3];
+    double distance;
+    unsigned int triangle;
+    unsigned int object;
+    unsigned int face;
+};
+
+int wavefrontObjectBvhCompose(struct WavefrontObjectBvh *bvh);
+int wavefrontObjectBvhBuild(struct WavefrontObjectBvh *bvh, const struct WavefrontObject *obj, unsigned int threadCount);
+void wavefrontObjectBvhRelease(struct WavefrontObjectBvh *bvh);
+int wavefrontObjectBvhIntersectRay(const struct WavefrontObjectBvh *bvh, const struct WavefrontObject *obj, const double origin[3], const double direction[3], double maxDistance, struct WavefrontObjectBvhHit *hit);
+int wavefrontObjectBvhNearestPoint(const struct WavefrontObjectBvh *bvh, const struct WavefrontObject *obj, const double point[3], struct WavefrontObjectBvhNearest *nearest);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
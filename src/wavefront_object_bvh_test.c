@@ -0,0 +1,188 @@
+#include "wavefront_object_bvh.h"
+#include "wavefront_object_parser.h"
+#include "wavefront_object_fixture.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+void bvhBuildEmptyObject() {
+    char input[] = "";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh bvh;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectBvhBuild(&bvh, &wObj, 1);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(bvh.nodeCount, 0);
+    double origin[3] = {0, 0, 1}, direction[3] = {0, 0, -1};
+    struct WavefrontObjectBvhHit hit;
+    assertIntegersEqual(wavefrontObjectBvhIntersectRay(&bvh, &wObj, origin, direction, 10, &hit), 0);
+    wavefrontObjectBvhRelease(&bvh);
+    wavefrontObjectRelease(&wObj);
+}
+
+void bvhSkipsLinesAndInvalidFaces() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 0 1 0\n\
+    l 1 2\n\
+    f 1 2 4\n\
+    f 1 2 3\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh bvh;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectBvhBuild(&bvh, &wObj, 1);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(bvh.triangleCount, 1);
+    assertIntegersEqual(bvh.triangles->face, 2);
+    wavefrontObjectBvhRelease(&bvh);
+    wavefrontObjectRelease(&wObj);
+}
+
+void bvhRayHitsQuad() {
+    char input[] = "\
+    o quad\n\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 1 1 0\n\
+    v 0 1 0\n\
+    f 1 2 3 4\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh bvh;
+    parseWavefrontObjectFromString(&wObj, input);
+    wavefrontObjectBvhBuild(&bvh, &wObj, 1);
+    assertIntegersEqual(bvh.triangleCount, 2);
+
+    double origin[3] = {0.25, 0.75, 2}, direction[3] = {0, 0, -1};
+    struct WavefrontObjectBvhHit hit;
+    assertIntegersEqual(wavefrontObjectBvhIntersectRay(&bvh, &wObj, origin, direction, 10, &hit), 1);
+    assertFloatsEqual(hit.t, 2.0);
+    assertIntegersEqual(hit.object, 0);
+    assertIntegersEqual(hit.face, 0);
+
+    // Too short to reach the quad.
+    assertIntegersEqual(wavefrontObjectBvhIntersectRay(&bvh, &wObj, origin, direction, 1, &hit), 0);
+
+    double miss[3] = {2, 2, 2};
+    assertIntegersEqual(wavefrontObjectBvhIntersectRay(&bvh, &wObj, miss, direction, 10, &hit), 0);
+    wavefrontObjectBvhRelease(&bvh);
+    wavefrontObjectRelease(&wObj);
+}
+
+void bvhNearestPointOnQuad() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 1 1 0\n\
+    v 0 1 0\n\
+    f 1 2 3 4\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh bvh;
+    parseWavefrontObjectFromString(&wObj, input);
+    wavefrontObjectBvhBuild(&bvh, &wObj, 1);
+
+    double above[3] = {0.5, 0.5, 3};
+    struct WavefrontObjectBvhNearest nearest;
+    assertIntegersEqual(wavefrontObjectBvhNearestPoint(&bvh, &wObj, above, &nearest), 1);
+    assertFloatsEqual(nearest.distance, 3.0);
+    assertFloatsEqual(nearest.point[0], 0.5);
+    assertFloatsEqual(nearest.point[1], 0.5);
+    assertFloatsEqual(nearest.point[2], 0.0);
+
+    double outside[3] = {2, 0.5, 0};
+    wavefrontObjectBvhNearestPoint(&bvh, &wObj, outside, &nearest);
+    assertFloatsEqual(nearest.distance, 1.0);
+    assertFloatsEqual(nearest.point[0], 1.0);
+    assertFloatsEqual(nearest.point[1], 0.5);
+    wavefrontObjectBvhRelease(&bvh);
+    wavefrontObjectRelease(&wObj);
+}
+
+void bvhSkipsNonFiniteVertices() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 0 1 0\n\
+    v nan nan nan\n\
+    v inf 0 0\n\
+    v 1e308 0 0\n\
+    v -1e308 1 0\n\
+    f 1 2 4\n\
+    f 5 2 3\n\
+    f 1 2 3\n\
+    f 6 7 1\n\
+    f 6 7 2\n\
+    f 6 7 3\n\
+    f 1 6 2\n\
+    f 1 7 3\n\
+    f 2 6 3\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh bvh;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectBvhBuild(&bvh, &wObj, 1);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(bvh.triangleCount, 7);
+    double origin[3] = {0.25, 0.25, 1}, direction[3] = {0, 0, -1};
+    struct WavefrontObjectBvhHit hit;
+    assertIntegersEqual(wavefrontObjectBvhIntersectRay(&bvh, &wObj, origin, direction, 10, &hit), 1);
+    assertFloatsEqual(hit.t, 1.0);
+    wavefrontObjectBvhRelease(&bvh);
+    wavefrontObjectRelease(&wObj);
+}
+
+void bvhParallelBuildMatchesSerial() {
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh serial, parallel;
+    composeGrid(&wObj, 64, 64);
+    assertIntegersEqual(wavefrontObjectBvhBuild(&serial, &wObj, 1), STATUS_OK);
+    assertIntegersEqual(wavefrontObjectBvhBuild(&parallel, &wObj, 4), STATUS_OK);
+    assertIntegersEqual(serial.triangleCount, 64 * 64 * 2);
+    assertIntegersEqual(parallel.triangleCount, 64 * 64 * 2);
+
+    int matches = 0;
+    for(unsigned int y = 0; y < 64; y += 7) {
+        for(unsigned int x = 0; x < 64; x += 5) {
+            double origin[3] = {x + 0.3, y + 0.6, 1}, direction[3] = {0, 0, -1};
+            struct WavefrontObjectBvhHit a, b;
+            int hitA = wavefrontObjectBvhIntersectRay(&serial, &wObj, origin, direction, 10, &a);
+            int hitB = wavefrontObjectBvhIntersectRay(&parallel, &wObj, origin, direction, 10, &b);
+            matches += hitA && hitB && a.face == b.face && a.face == y * 64 + x;
+        }
+    }
+    assertIntegersEqual(matches, 10 * 13);
+
+    double point[3] = {10.2, 20.7, -4};
+    struct WavefrontObjectBvhNearest nearest;
+    wavefrontObjectBvhNearestPoint(&parallel, &wObj, point, &nearest);
+    assertFloatsEqual(nearest.distance, 4.0);
+    assertIntegersEqual(nearest.face, 20 * 64 + 10);
+    wavefrontObjectBvhRelease(&serial);
+    wavefrontObjectBvhRelease(&parallel);
+    wavefrontObjectRelease(&wObj);
+}
+
+void bvhBuildClampsThreadCount() {
+    struct WavefrontObject wObj;
+    struct WavefrontObjectBvh serial, parallel;
+    composeGrid(&wObj, 128, 128);
+    assertIntegersEqual(wavefrontObjectBvhBuild(&serial, &wObj, 1), STATUS_OK);
+    assertIntegersEqual(wavefrontObjectBvhBuild(&parallel, &wObj, UINT_MAX), STATUS_OK);
+    assertIntegersEqual(parallel.triangleCount, serial.triangleCount);
+    assertIntegersEqual(parallel.nodeCount, serial.nodeCount);
+    double origin[3] = {100.3, 40.6, 1}, direction[3] = {0, 0, -1};
+    struct WavefrontObjectBvhHit hit;
+    assertIntegersEqual(wavefrontObjectBvhIntersectRay(&parallel, &wObj, origin, direction, 10, &hit), 1);
+    assertIntegersEqual(hit.face, 40 * 128 + 100);
+    wavefrontObjectBvhRelease(&serial);
+    wavefrontObjectBvhRelease(&parallel);
+    wavefrontObjectRelease(&wObj);
+}
+
+void wavefrontObjectBvhTest() {
+    bvhBuildEmptyObject();
+    bvhSkipsLinesAndInvalidFaces();
+    bvhRayHitsQuad();
+    bvhNearestPointOnQuad();
+    bvhSkipsNonFiniteVertices();
+    bvhParallelBuildMatchesSerial();
+    bvhBuildClampsThreadCount();
+}
@@ -0,0 +1,35 @@
+#ifndef __WAVEFRONT_OBJECT_FIXTURE_H
+#define __WAVEFRONT_OBJECT_FIXTURE_H
+
+#include "wavefront_object.h"
+
+// Flat size by size grid of quads in the z = 0 plane, one unit apart, in an
+// object named grid. Faces left of split use material 0 and the rest material 1.
+static void composeGrid(struct WavefrontObject *wObj, unsigned int size, unsigned int split) {
+    wavefrontObjectCompose(wObj);
+    wavefrontObjectAddObject(wObj, "grid");
+    wavefrontObjectAddMaterial(wObj, "left");
+    wavefrontObjectAddMaterial(wObj, "right");
+    for(unsigned int y = 0; y <= size; y++) {
+        for(unsigned int x = 0; x <= size; x++) {
+            struct WavefrontObjectVertex vertex = {1.0, x, y, 0.0};
+            wavefrontObjectAddVertex(wObj, &vertex);
+        }
+    }
+    for(unsigned int y = 0; y < size; y++) {
+        for(unsigned int x = 0; x < size; x++) {
+            int corner = y * (size + 1) + x + 1;
+            struct WavefrontObjectPoint points[4] = {
+                {corner, 0, 0},
+                {corner + 1, 0, 0},
+                {corner + size + 2, 0, 0},
+                {corner + size + 1, 0, 0}};
+            struct WavefrontObjectFace *face = wavefrontObjectNextFace(wObj);
+            wavefrontObjectFaceSetPoints(face, points, 4);
+            wObj->currentMaterial = x < split ? 0 : 1;
+            wavefrontObjectAddFace(wObj, face);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,419 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "wavefront_object.h"
+#include "wavefront_object_batch.h"
+#include "wavefront_object_incremental.h"
+#include "wavefront_object_parser.h"
+#include "wavefront_object_stream.h"
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+
+// Differential fuzz target. Every parse mode is run over the same input and
+// must agree with a slow reference parser kept in this file on the status
+// and, when that succeeds, on every field of the object. A disagreement
+// aborts so libFuzzer and AFL record the input as a crash.
+//
+// Built with COBJ_LIBFUZZER the file only provides LLVMFuzzerTestOneInput.
+// Otherwise main checks each file named on the command line, - for stdin, so
+// AFL can drive it with @@ or -, and with no files runs -runs=N mutations of
+// the seeds below so make fuzz works without any fuzzing engine installed.
+// File input is written under FUZZ_FILE_PREFIX, those modes are skipped when
+// it cannot be created.
+
+#ifndef FUZZ_FILE_PREFIX
+#define FUZZ_FILE_PREFIX "bin/fuzz_input"
+#endif
+
+static const char *seeds[] = {
+    "",
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n",
+    "mtllib a.mtl b.mtl\no cube\nv 1 1 1 0.5\nvt 0 1\nvn 0 0 1\nusemtl red\nf 1/1/1 1/1/1 1/1/1\n",
+    "o a\nv 0 0 0\nf 1 1 1\no b\nusemtl blue\nf 1//1 -1//-1 1//1\no a\nf 1/1 1/1 1/1\n",
+    "# comment\r\n\r\nv 1e3 -2.5 .5\r\nvt 1\r\nvn 1 2 3\r\nf 1 1 1 1 1 1 1 1 1 1\r\n",
+    "v 0 0 0\nf 1 2\nf 99999999999999999999 1 1\nl 1 2\ns off\ng group\n",
+    "usemtl a\nusemtl b\nusemtl a\no x\nusemtl b\nf 1 1 1",
+};
+
+static const char *tokens[] = {
+    "v ", "vt ", "vn ", "f ", "o ", "usemtl ", "mtllib ", "#", "/", "//", " ",
+    "\n", "\r\n", "\t", "-", "1", "0.5", "-1", "2147483648", "nan", "1e308",
+};
+
+static void fail(const char *mode, const char *input) {
+    fprintf(stderr, "%s disagrees on input:\n%s\n", mode, input);
+    abort();
+}
+
+static void check(const char *mode, const char *input, int expected, const struct WavefrontObject *reference, int result, const struct WavefrontObject *obj) {
+    if(result != expected) fail(mode, input);
+    if(expected == STATUS_OK && !wavefrontObjectEqual(reference, obj)) fail(mode, input);
+}
+
+// The reference shares nothing with the library parser but the element
+// builders. Lines and fields are split a byte at a time with cutil's tokenize
+// as the original parser did, and indices are accumulated digit by digit
+// rather than through strtoll.
+
+static int referenceIndex(WavefrontObjectIndex *index, const char *start, const char *end) {
+    int negative = 0;
+    if(start < end && (*start == '-' || *start == '+')) negative = *start++ == '-';
+    long long value = 0;
+    for(; start < end; start++) {
+        if(*start < '0' || *start > '9') return STATUS_PARSE_ERR;
+        int digit = *start - '0';
+        if(value > ((long long)WAVEFRONT_OBJECT_COUNT_MAX - digit) / 10) return STATUS_PARSE_ERR;
+        value = value * 10 + digit;
+    }
+    *index = (WavefrontObjectIndex)(negative ? -value : value);
+    return STATUS_OK;
+}
+
+// v, v/vt, v//vn or v/vt/vn. Only a middle index may be left empty.
+static int referencePoint(struct WavefrontObjectPoint *point, const char *token) {
+    WavefrontObjectIndex indices[3] = {0, 0, 0};
+    const char *part = token;
+    for(int i = 0;; i++) {
+        const char *end = part;
+        while(*end && *end != '/') end++;
+        if(i > 2) return STATUS_PARSE_ERR;
+        if(part == end) {
+            if(i == 0 || *end == '\0') return STATUS_PARSE_ERR;
+        } else if(referenceIndex(indices + i, part, end)) {
+            return STATUS_PARSE_ERR;
+        }
+        if(*end == '\0') break;
+        part = end + 1;
+    }
+    point->v = indices[0];
+    point->vt = indices[1];
+    point->vn = indices[2];
+    return STATUS_OK;
+}
+
+static int referenceFace(struct WavefrontObject *obj, const char *line) {
+    struct WavefrontObjectFace face;
+    face.points = NULL;
+    face.pointCount = 0;
+    int result = STATUS_OK;
+    const char *thisToken = line, *nextDelim = NULL, *nextToken = NULL;
+    while(result == STATUS_OK && tokenize(&thisToken, &nextDelim, &nextToken, ASCII_H_DELIMITERS)) {
+        char *token = strCopyN(thisToken, nextDelim - thisToken);
+        struct WavefrontObjectPoint point;
+        result = token ? referencePoint(&point, token) : STATUS_ALLOC_ERR;
+        if(result == STATUS_OK) result = wavefrontObjectFaceAddPoint(&face, &point);
+        free(token);
+    }
+    if(result == STATUS_OK) result = wavefrontObjectAddFace(obj, &face);
+    if(result) wavefrontObjectFaceFree(&face);
+    return result;
+}
+
+static int referenceMaterialLibraries(struct WavefrontObject *obj, const char *line) {
+    int result = STATUS_OK;
+    const char *thisToken = line, *nextDelim = NULL, *nextToken = NULL;
+    while(result == STATUS_OK && tokenize(&thisToken, &nextDelim, &nextToken, ASCII_H_DELIMITERS)) {
+        if(thisToken == nextDelim) continue;
+        char *token = strCopyN(thisToken, nextDelim - thisToken);
+        result = token ? wavefrontObjectAddMaterialLibrary(obj, token) : STATUS_ALLOC_ERR;
+        free(token);
+    }
+    return result;
+}
+
+static int isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static int referenceLine(struct WavefrontObject *obj, const char *line) {
+    while(isBlank(*line)) line++;
+    const char *end = line;
+    while(*end && !isBlank(*end)) end++;
+    const char *arguments = end;
+    while(isBlank(*arguments)) arguments++;
+    unsigned long length = end - line;
+    if(length == 1 && *line == 'v') {
+        struct WavefrontObjectVertex vertex = {1.0, 0, 0, 0};
+        if(sscanf(arguments, "%lf %lf %lf %lf", &vertex.x, &vertex.y, &vertex.z, &vertex.w) < 3) return STATUS_PARSE_ERR;
+        return wavefrontObjectAddVertex(obj, &vertex);
+    }
+    if(length == 2 && memcmp(line, "vt", 2) == 0) {
+        struct WavefrontObjectUnwrap unwrap = {0, 0, 0};
+        if(sscanf(arguments, "%lf %lf %lf", &unwrap.u, &unwrap.v, &unwrap.w) < 2) return STATUS_PARSE_ERR;
+        return wavefrontObjectAddUnwrap(obj, &unwrap);
+    }
+    if(length == 2 && memcmp(line, "vn", 2) == 0) {
+        struct WavefrontObjectNormal normal;
+        if(sscanf(arguments, "%lf %lf %lf", &normal.x, &normal.y, &normal.z) != 3) return STATUS_PARSE_ERR;
+        return wavefrontObjectAddNormal(obj, &normal);
+    }
+    if(length == 1 && (*line == 'f' || *line == 'l')) return referenceFace(obj, arguments);
+    if(length == 6 && memcmp(line, "mtllib", 6) == 0) return referenceMaterialLibraries(obj, arguments);
+    if(length == 6 && memcmp(line, "usemtl", 6) == 0) return wavefrontObjectAddMaterial(obj, arguments);
+    if(length == 1 && *line == 'o') return wavefrontObjectAddObject(obj, arguments);
+    return STATUS_OK;
+}
+
+static int referenceParse(struct WavefrontObject *obj, const char *input, unsigned long errorLimit) {
+    unsigned long errorCount = 0;
+    wavefrontObjectCompose(obj);
+    const char *thisToken = input, *nextDelim = NULL, *nextToken = NULL;
+    while(tokenize(&thisToken, &nextDelim, &nextToken, ASCII_V_DELIMITERS)) {
+        char *line = strCopyN(thisToken, nextDelim - thisToken);
+        int result = line ? referenceLine(obj, line) : STATUS_ALLOC_ERR;
+        free(line);
+        if(result == STATUS_PARSE_ERR && ++errorCount <= errorLimit) result = STATUS_OK;
+        if(result) {
+            wavefrontObjectRelease(obj);
+            return result;
+        }
+    }
+    return STATUS_OK;
+}
+
+// Write input as a plain and a gzip file, returning 0 when either fails.
+static int writeFiles(const char *input, unsigned long size, const char *plainPath, const char *gzipPath) {
+    FILE *file = fopen(plainPath, "wb");
+    if(file == NULL) return 0;
+    int written = fwrite(input, 1, size, file) == size;
+    written &= fclose(file) == 0;
+    gzFile gz = gzopen(gzipPath, "wb");
+    if(gz == NULL) return 0;
+    if(size) written &= gzwrite(gz, input, (unsigned int)size) == (int)size;
+    written &= gzclose(gz) == Z_OK;
+    return written;
+}
+
+struct MemoryReader {
+    const char *input;
+    unsigned long size;
+    unsigned long chunk;
+};
+
+static long readMemory(void *context, char *buffer, unsigned long size) {
+    struct MemoryReader *reader = (struct MemoryReader*)context;
+    if(size > reader->chunk) size = reader->chunk;
+    if(size > reader->size) size = reader->size;
+    memcpy(buffer, reader->input, size);
+    reader->input += size;
+    reader->size -= size;
+    return (long)size;
+}
+
+static int parseChunked(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *input, unsigned long size, unsigned long chunk) {
+    wavefrontObjectCompose(obj);
+    wavefrontObjectParserBegin(parser);
+    int result = STATUS_OK;
+    for(unsigned long offset = 0; result == STATUS_OK && offset < size; offset += chunk) {
+        unsigned long length = size - offset < chunk ? size - offset : chunk;
+        result = wavefrontObjectParserParseBlock(parser, obj, input + offset, length);
+    }
+    if(result == STATUS_OK) result = wavefrontObjectParserFinish(parser, obj);
+    if(result != STATUS_OK) wavefrontObjectRelease(obj);
+    return result;
+}
+
+static void differential(const char *input, unsigned long errorLimit) {
+    unsigned long size = strlen(input);
+    unsigned long chunk = 1 + size % 7;
+    struct WavefrontObjectParser parser;
+    struct WavefrontObject reference, obj;
+    if(wavefrontObjectParserCompose(&parser) != STATUS_OK) return;
+    parser.errorLimit = errorLimit;
+
+    int expected = referenceParse(&reference, input, errorLimit);
+
+    int result = wavefrontObjectParserParseString(&parser, &obj, input);
+    check("ParseString", input, expected, &reference, result, &obj);
+    if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+
+    result = parseChunked(&parser, &obj, input, size, chunk);
+    check("ParseBlock", input, expected, &reference, result, &obj);
+    if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+
+    // Into an object still holding a different model.
+    wavefrontObjectCompose(&obj);
+    wavefrontObjectParserParseStringInto(&parser, &obj, seeds[2]);
+    result = wavefrontObjectParserParseStringInto(&parser, &obj, input);
+    check("ParseStringInto", input, expected, &reference, result, &obj);
+    wavefrontObjectRelease(&obj);
+
+    struct MemoryReader reader = {input, size, chunk};
+    result = wavefrontObjectParserParseReader(&parser, &obj, readMemory, &reader);
+    check("ParseReader", input, expected, &reference, result, &obj);
+    if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+
+    // A cold load, then the same input again with every section reused.
+    struct WavefrontObjectIncremental incremental;
+    wavefrontObjectIncrementalCompose(&incremental);
+    wavefrontObjectIncrementalLoad(&incremental, &parser, seeds[3]);
+    result = wavefrontObjectIncrementalLoad(&incremental, &parser, input);
+    check("IncrementalLoad", input, expected, &reference, result, &incremental.obj);
+    if(result == STATUS_OK) {
+        result = wavefrontObjectIncrementalLoad(&incremental, &parser, input);
+        check("IncrementalReload", input, expected, &reference, result, &incremental.obj);
+    }
+    wavefrontObjectIncrementalRelease(&incremental);
+
+    const char *plainPath = FUZZ_FILE_PREFIX ".obj", *gzipPath = FUZZ_FILE_PREFIX ".obj.gz";
+    if(writeFiles(input, size, plainPath, gzipPath)) {
+        result = wavefrontObjectParserParseFile(&parser, &obj, plainPath);
+        check("ParseFile", input, expected, &reference, result, &obj);
+        if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+
+        result = wavefrontObjectParserParseFile(&parser, &obj, gzipPath);
+        check("ParseFile gzip", input, expected, &reference, result, &obj);
+        if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+    }
+
+    if(errorLimit == 0) {
+        result = parseWavefrontObjectFromString(&obj, (char*)input);
+        check("FromString", input, expected, &reference, result, &obj);
+        if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+
+        reader = (struct MemoryReader){input, size, chunk};
+        result = parseWavefrontObjectFromReader(&obj, readMemory, &reader);
+        check("FromReader", input, expected, &reference, result, &obj);
+        if(result == STATUS_OK) wavefrontObjectRelease(&obj);
+
+        struct WavefrontObject objs[2];
+        int statuses[2];
+        const char *inputs[2] = {seeds[1], input};
+        wavefrontObjectBatchParseStrings(objs, statuses, inputs, 2, 2);
+        check("BatchParseStrings", input, expected, &reference, statuses[1], objs + 1);
+        for(int i = 0; i < 2; i++) {
+            if(statuses[i] == STATUS_OK) wavefrontObjectRelease(objs + i);
+        }
+    }
+
+    if(expected == STATUS_OK) wavefrontObjectRelease(&reference);
+    wavefrontObjectParserRelease(&parser);
+}
+
+static void checkInput(const char *input) {
+    differential(input, 0);
+    differential(input, (unsigned long)-1);
+}
+
+// Inputs stop at the first NUL, the string entry points could not see past it.
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    char *input = (char*)malloc(size + 1);
+    if(input == NULL) return 0;
+    memcpy(input, data, size);
+    input[size] = '\0';
+    checkInput(input);
+    free(input);
+    return 0;
+}
+
+#ifndef COBJ_LIBFUZZER
+
+#define FUZZ_MAX_SIZE 4096
+
+static unsigned long long fuzzState = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long fuzzRandom(unsigned long bound) {
+    fuzzState ^= fuzzState << 13;
+    fuzzState ^= fuzzState >> 7;
+    fuzzState ^= fuzzState << 17;
+    return (unsigned long)(fuzzState % bound);
+}
+
+static unsigned long insert(char *input, unsigned long size, unsigned long at, const char *text, unsigned long length) {
+    if(size + length > FUZZ_MAX_SIZE) return size;
+    memmove(input + at + length, input + at, size - at);
+    memcpy(input + at, text, length);
+    return size + length;
+}
+
+// A handful of edits per run: overwrite, insert a token, delete or duplicate
+// a range, or splice in another seed.
+static unsigned long mutate(char *input, unsigned long size) {
+    unsigned long edits = 1 + fuzzRandom(4);
+    for(unsigned long i = 0; i < edits; i++) {
+        unsigned long at = fuzzRandom(size + 1);
+        const char *token = tokens[fuzzRandom(sizeof(tokens) / sizeof(*tokens))];
+        const char *seed = seeds[fuzzRandom(sizeof(seeds) / sizeof(*seeds))];
+        unsigned long length = fuzzRandom(size - at + 1);
+        switch(fuzzRandom(5)) {
+        case 0:
+            if(at < size) input[at] = token[0];
+            break;
+        case 1:
+            size = insert(input, size, at, token, strlen(token));
+            break;
+        case 2:
+            memmove(input + at, input + at + length, size - at - length);
+            size -= length;
+            break;
+        case 3:
+            if(size + length > FUZZ_MAX_SIZE) break;
+            memmove(input + at + length, input + at, size - at);
+            size += length;
+            break;
+        default:
+            size = insert(input, size, at, seed, strlen(seed));
+            break;
+        }
+    }
+    input[size] = '\0';
+    return size;
+}
+
+static int checkFile(FILE *file, const char *name) {
+    unsigned long size = 0, capacity = 4096;
+    char *input = (char*)malloc(capacity);
+    while(input != NULL) {
+        size += fread(input + size, 1, capacity - size, file);
+        if(size < capacity) break;
+        capacity *= 2;
+        char *grown = (char*)realloc(input, capacity);
+        if(grown == NULL) free(input);
+        input = grown;
+    }
+    if(input == NULL || ferror(file)) {
+        fprintf(stderr, "Could not read %s\n", name);
+        free(input);
+        return 1;
+    }
+    LLVMFuzzerTestOneInput((const uint8_t*)input, size);
+    free(input);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned long runs = 1000;
+    int files = 0, failed = 0;
+    for(int i = 1; i < argc; i++) {
+        if(strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoul(argv[i] + 6, NULL, 10);
+            continue;
+        }
+        FILE *file = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], "rb");
+        if(file == NULL) {
+            fprintf(stderr, "Could not open %s\n", argv[i]);
+            failed = 1;
+        } else {
+            failed |= checkFile(file, argv[i]);
+            if(file != stdin) fclose(file);
+        }
+        files++;
+    }
+    if(files) return failed;
+
+    static char input[FUZZ_MAX_SIZE + 1];
+    for(unsigned long i = 0; i < sizeof(seeds) / sizeof(*seeds); i++) checkInput(seeds[i]);
+    for(unsigned long run = 0; run < runs; run++) {
+        const char *seed = seeds[fuzzRandom(sizeof(seeds) / sizeof(*seeds))];
+        unsigned long size = strlen(seed);
+        memcpy(input, seed, size + 1);
+        mutate(input, size);
+        checkInput(input);
+    }
+    printf("Differential runs passed: %lu\n", runs);
+    return 0;
+}
+
+#endif
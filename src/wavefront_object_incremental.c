@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_incremental.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+int wavefrontObjectIncrementalCompose(struct WavefrontObjectIncremental *incremental) {
+    memset(incremental, 0, sizeof(struct WavefrontObjectIncremental));
+    return wavefrontObjectCompose(&incremental->obj);
+}
+
+void wavefrontObjectIncrementalRelease(struct WavefrontObjectIncremental *incremental) {
+    wavefrontObjectRelease(&incremental->obj);
+    free(incremental->input);
+    free(incremental->sections);
+    free(incremental->materialUses);
+}
+
+static int isDelimiter(char c, const char *delimiters) {
+    return c != '\0' && strchr(delimiters, c) != NULL;
+}
+
+// Whether the line in [line, end) is an o line, using the parser's keyword rules.
+static int startsObject(const char *line, const char *end) {
+    while(line < end && isDelimiter(*line, ASCII_H_DELIMITERS)) line++;
+    return line < end && *line == 'o'
+        && (line + 1 == end || isDelimiter(line[1], ASCII_H_DELIMITERS) || isDelimiter(line[1], ASCII_V_DELIMITERS));
+}
+
+static void describeSection(struct WavefrontObjectSection *section, const char *input, unsigned long start, unsigned long end) {
+    unsigned long long hash = FNV_OFFSET;
+    for(unsigned long i = start; i < end; i++) {
+        hash = (hash ^ (unsigned char)input[i]) * FNV_PRIME;
+        // Counted as the parser numbers lines, CR, LF and CRLF ending one each.
+        section->lineCount += input[i] == '\r' || (input[i] == '\n' && (i == 0 || input[i - 1] != '\r'));
+    }
+    section->hash = hash;
+    section->offset = start;
+    section->size = end - start;
+}
+
+// Split input before every o line but the first line, describing the sections
+// when given, and return the section count. The first section holds the lines
+// before the second o line, or all of them when there is none.
+static WavefrontObjectCount splitSections(const char *input, unsigned long size, struct WavefrontObjectSection *sections) {
+    WavefrontObjectCount count = 1;
+    unsigned long start = 0, lineStart = 0;
+    for(unsigned long i = 0; i <= size; i++) {
+        if(i < size && !isDelimiter(input[i], ASCII_V_DELIMITERS)) continue;
+        if(lineStart > 0 && startsObject(input + lineStart, input + i)) {
+            if(sections) describeSection(sections + count - 1, input, start, lineStart);
+            start = lineStart;
+            count++;
+        }
+        lineStart = i + 1;
+    }
+    if(sections) describeSection(sections + count - 1, input, start, size);
+    return count;
+}
+
+static int pushUse(struct WavefrontObjectIncremental *incremental, WavefrontObjectCount material) {
+    if(incremental->materialUseCount == incremental->materialUseCapacity) {
+        WavefrontObjectCount capacity = incremental->materialUseCapacity ? incremental->materialUseCapacity * 2 : 16;
+        WavefrontObjectCount *temp = (WavefrontObjectCount*)realloc(
+            incremental->materialUses,
+            capacity * sizeof(WavefrontObjectCount));
+        if(temp == NULL) return STATUS_ALLOC_ERR;
+        incremental->materialUses = temp;
+        incremental->materialUseCapacity = capacity;
+    }
+    incremental->materialUses[incremental->materialUseCount++] = material;
+    return STATUS_OK;
+}
+
+// Builds the object like wavefrontObjectBuilder while noting usemtl lines and
+// the faces before the first of them in the current section.
+struct SectionRecorder {
+    struct WavefrontObjectIncremental *next;
+    struct WavefrontObjectSection *section;
+};
+
+static int recordVertex(void *context, const struct WavefrontObjectVertex *vertex) {
+    return wavefrontObjectBuilder.onVertex(&((struct SectionRecorder*)context)->next->obj, vertex);
+}
+
+static int recordUnwrap(void *context, const struct WavefrontObjectUnwrap *unwrap) {
+    return wavefrontObjectBuilder.onUnwrap(&((struct SectionRecorder*)context)->next->obj, unwrap);
+}
+
+static int recordNormal(void *context, const struct WavefrontObjectNormal *normal) {
+    return wavefrontObjectBuilder.onNormal(&((struct SectionRecorder*)context)->next->obj, normal);
+}
+
+static int recordFace(void *context, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount) {
+    struct SectionRecorder *recorder = (struct SectionRecorder*)context;
+    if(recorder->next->materialUseCount == recorder->section->useStart) recorder->section->leadingFaceCount++;
+    return wavefrontObjectBuilder.onFace(&recorder->next->obj, points, pointCount);
+}
+
+static int recordObject(void *context, const char *name) {
+    return wavefrontObjectBuilder.onObject(&((struct SectionRecorder*)context)->next->obj, name);
+}
+
+static int recordMaterial(void *context, const char *name) {
+    struct SectionRecorder *recorder = (struct SectionRecorder*)context;
+    int result = wavefrontObjectBuilder.onMaterial(&recorder->next->obj, name);
+    return result ? result : pushUse(recorder->next, recorder->next->obj.currentMaterial);
+}
+
+static int recordMaterialLibrary(void *context, const char *name) {
+    return wavefrontObjectBuilder.onMaterialLibrary(&((struct SectionRecorder*)context)->next->obj, name);
+}
+
+static const struct WavefrontObjectCallbacks recordCallbacks = {
+    recordVertex,
+    recordUnwrap,
+    recordNormal,
+    recordFace,
+    recordObject,
+    recordMaterial,
+    recordMaterialLibrary
+};
+
+// Copy what a section of the previous load produced, rebased onto the
+// counts and material table built so far. remap has a slot per previous material.
+static int spliceSection(
+        struct WavefrontObjectIncremental *next,
+        struct WavefrontObjectIncremental *previous,
+        const struct WavefrontObjectSection *from,
+        WavefrontObjectCount *remap) {
+    struct WavefrontObject *obj = &next->obj, *old = &previous->obj;
+    for(WavefrontObjectCount i = 0; i < from->libraryCount; i++) {
+        if(wavefrontObjectAddMaterialLibrary(obj, old->materialLibraries[from->libraryStart + i])) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < from->vertexCount; i++) {
+        if(wavefrontObjectAddVertex(obj, old->vertices + from->vertexStart + i)) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < from->unwrapCount; i++) {
+        if(wavefrontObjectAddUnwrap(obj, old->unwraps + from->unwrapStart + i)) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < from->normalCount; i++) {
+        if(wavefrontObjectAddNormal(obj, old->normals + from->normalStart + i)) return STATUS_ALLOC_ERR;
+    }
+
+    // Replaying usemtl lines in order interns materials as a full parse would.
+    WavefrontObjectIndex entryMaterial = obj->currentMaterial;
+    for(WavefrontObjectCount i = 0; i < from->useCount; i++) {
+        WavefrontObjectCount material = previous->materialUses[from->useStart + i];
+        if(wavefrontObjectAddMaterial(obj, old->materials[material])) return STATUS_ALLOC_ERR;
+        remap[material] = obj->currentMaterial;
+        if(pushUse(next, obj->currentMaterial)) return STATUS_ALLOC_ERR;
+    }
+    WavefrontObjectIndex exitMaterial = obj->currentMaterial;
+
+    if(from->object >= 0) {
+        const struct WavefrontObjectObject *o = old->objects + from->object;
+        if(wavefrontObjectAddObject(obj, o->name)) return STATUS_ALLOC_ERR;
+        for(WavefrontObjectCount i = 0; i < o->faceCount; i++) {
+            const struct WavefrontObjectFace *source = o->faces + i;
+            // Faces before the section's first usemtl take whatever material was current.
+            obj->currentMaterial = i < from->leadingFaceCount ? entryMaterial : (WavefrontObjectIndex)remap[source->material];
+            if(wavefrontObjectBuilder.onFace(obj, source->points, source->pointCount)) return STATUS_ALLOC_ERR;
+        }
+    }
+    obj->currentMaterial = exitMaterial;
+    return STATUS_OK;
+}
+
+// Parse input into a new object, copying every section whose text matches one
+// of the previous load byte for byte rather than parsing it again. Face indices are kept as
+// written, so an unchanged section yields the same faces wherever it lands and
+// only its attributes and materials need rebasing. On failure the previous
+// load is left as it was.
+int wavefrontObjectIncrementalLoad(
+        struct WavefrontObjectIncremental *incremental,
+        struct WavefrontObjectParser *parser,
+        const char *input) {
+    unsigned long size = strlen(input);
+    struct WavefrontObjectIncremental next;
+    wavefrontObjectIncrementalCompose(&next);
+    next.sectionCount = splitSections(input, size, NULL);
+
+    // Previous sections by hash, open addressed with index + 1 in each slot.
+    WavefrontObjectCount tableSize = 1;
+    while(tableSize < 2 * incremental->sectionCount) tableSize *= 2;
+    next.sections = (struct WavefrontObjectSection*)calloc(next.sectionCount, sizeof(struct WavefrontObjectSection));
+    WavefrontObjectCount *table = (WavefrontObjectCount*)calloc(tableSize, sizeof(WavefrontObjectCount));
+    WavefrontObjectCount *remap = (WavefrontObjectCount*)malloc((incremental->obj.materialCount + 1) * sizeof(WavefrontObjectCount));
+    next.input = (char*)malloc(size + 1);
+    int result = STATUS_ALLOC_ERR;
+    if(next.sections && table && remap && next.input) {
+        memcpy(next.input, input, size + 1);
+        for(WavefrontObjectCount i = 0; i < incremental->sectionCount; i++) {
+            WavefrontObjectCount slot = incremental->sections[i].hash & (tableSize - 1);
+            while(table[slot]) slot = (slot + 1) & (tableSize - 1);
+            table[slot] = i + 1;
+        }
+        splitSections(input, size, next.sections);
+        wavefrontObjectParserBegin(parser);
+        result = STATUS_OK;
+
+        unsigned long lineNumber = 0;
+        for(WavefrontObjectCount i = 0; i < next.sectionCount && result == STATUS_OK; i++) {
+            struct WavefrontObjectSection *section = next.sections + i;
+            const struct WavefrontObjectSection *from = NULL;
+            for(WavefrontObjectCount slot = section->hash & (tableSize - 1); table[slot]; slot = (slot + 1) & (tableSize - 1)) {
+                const struct WavefrontObjectSection *candidate = incremental->sections + table[slot] - 1;
+                if(candidate->hash == section->hash && candidate->size == section->size
+                        && memcmp(incremental->input + candidate->offset, input + section->offset, section->size) == 0) {
+                    from = candidate;
+                    break;
+                }
+            }
+
+            struct WavefrontObject *obj = &next.obj;
+            WavefrontObjectCount objectCount = obj->objectCount;
+            unsigned long errorCount = parser->errorCount;
+            section->vertexStart = obj->vertexCount;
+            section->unwrapStart = obj->unwrapCount;
+            section->normalStart = obj->normalCount;
+            section->libraryStart = obj->materialLibraryCount;
+            section->useStart = next.materialUseCount;
+            if(from) {
+                result = spliceSection(&next, incremental, from, remap);
+                section->leadingFaceCount = from->leadingFaceCount;
+                // Lines skipped before still count against the error limit.
+                parser->errorCount += from->errorCount;
+                if(result == STATUS_OK && parser->errorCount > parser->errorLimit) result = STATUS_PARSE_ERR;
+            } else {
+                struct SectionRecorder recorder = {&next, section};
+                parser->lineNumber = lineNumber;
+                parser->carriageReturn = 0;
+                result = wavefrontObjectParserParseBlockCallbacks(parser, &recordCallbacks, &recorder, input + section->offset, section->size);
+                if(result == STATUS_OK) result = wavefrontObjectParserFinishCallbacks(parser, &recordCallbacks, &recorder);
+                next.reparsedCount++;
+            }
+            section->vertexCount = obj->vertexCount - section->vertexStart;
+            section->unwrapCount = obj->unwrapCount - section->unwrapStart;
+            section->normalCount = obj->normalCount - section->normalStart;
+            section->libraryCount = obj->materialLibraryCount - section->libraryStart;
+            section->useCount = next.materialUseCount - section->useStart;
+            section->object = obj->objectCount > objectCount ? (WavefrontObjectIndex)objectCount : -1;
+            section->errorCount = parser->errorCount - errorCount;
+            lineNumber += section->lineCount;
+        }
+    }
+    free(table);
+    free(remap);
+    if(result) {
+        wavefrontObjectIncrementalRelease(&next);
+        return result;
+    }
+    wavefrontObjectIncrementalRelease(incremental);
+    *incremental = next;
+    return STATUS_OK;
+}
@@ -0,0 +1,50 @@
+#ifndef __WAVEFRONT_OBJECT_INCREMENTAL_H
+#define __WAVEFRONT_OBJECT_INCREMENTAL_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+#include "wavefront_object_parser.h"
+
+// A run of input from one o line to the next, the first also holding any
+// lines before it, and where its elements landed in the loaded object. The
+// use range indexes materialUses, one material per usemtl line. The hash only
+// narrows the search, a section is reused once its bytes at offset match.
+struct WavefrontObjectSection {
+    unsigned long long hash;
+    unsigned long offset;
+    unsigned long size;
+    unsigned long lineCount;
+    unsigned long errorCount;
+    WavefrontObjectCount vertexStart, vertexCount;
+    WavefrontObjectCount unwrapStart, unwrapCount;
+    WavefrontObjectCount normalStart, normalCount;
+    WavefrontObjectCount libraryStart, libraryCount;
+    WavefrontObjectCount useStart, useCount;
+    WavefrontObjectCount leadingFaceCount;
+    WavefrontObjectIndex object;
+};
+
+// The last successful load and a copy of its input. reparsedCount says how
+// many of its sections had to be parsed, the rest were copied from the load
+// before.
+struct WavefrontObjectIncremental {
+    struct WavefrontObject obj;
+    char *input;
+    struct WavefrontObjectSection *sections;
+    WavefrontObjectCount *materialUses;
+    WavefrontObjectCount sectionCount;
+    WavefrontObjectCount materialUseCount;
+    WavefrontObjectCount materialUseCapacity;
+    WavefrontObjectCount reparsedCount;
+};
+
+int wavefrontObjectIncrementalCompose(struct WavefrontObjectIncremental *incremental);
+void wavefrontObjectIncrementalRelease(struct WavefrontObjectIncremental *incremental);
+int wavefrontObjectIncrementalLoad(struct WavefrontObjectIncremental *incremental, struct WavefrontObjectParser *parser, const char *input);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include "wavefront_object_incremental.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+static const char incrementalBefore[] = "\
+mtllib scene.mtl\n\
+usemtl base\n\
+o first\n\
+v 0 0 0\n\
+v 1 0 0\n\
+v 1 1 0\n\
+f 1 2 3\n\
+usemtl red\n\
+f 3 2 1\n\
+o second\n\
+v 0 0 1\n\
+vn 0 0 1\n\
+f 4//1 1//1 2//1\n\
+usemtl blue\n\
+f 4 2 3\n\
+o third\n\
+v 5 5 5\n\
+f 5 4 3\n";
+
+// first grows a vertex and swaps its material, second and third are unchanged.
+static const char incrementalAfter[] = "\
+mtllib scene.mtl\n\
+usemtl base\n\
+o first\n\
+v 0 0 0\n\
+v 2 0 0\n\
+v 1 1 0\n\
+v 1 2 0\n\
+f 1 2 3\n\
+usemtl green\n\
+f 3 2 1\n\
+o second\n\
+v 0 0 1\n\
+vn 0 0 1\n\
+f 4//1 1//1 2//1\n\
+usemtl blue\n\
+f 4 2 3\n\
+o third\n\
+v 5 5 5\n\
+f 5 4 3\n";
+
+void incrementalReparsesChangedSections() {
+    struct WavefrontObjectParser parser;
+    struct WavefrontObjectIncremental incremental;
+    struct WavefrontObject full;
+    wavefrontObjectParserCompose(&parser);
+    wavefrontObjectIncrementalCompose(&incremental);
+
+    int result = wavefrontObjectIncrementalLoad(&incremental, &parser, incrementalBefore);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(incremental.sectionCount, 4);
+    assertIntegersEqual(incremental.reparsedCount, 4);
+    parseWavefrontObjectFromString(&full, (char*)incrementalBefore);
+    assertIntegersEqual(wavefrontObjectEqual(&incremental.obj, &full), 1);
+    wavefrontObjectRelease(&full);
+
+    result = wavefrontObjectIncrementalLoad(&incremental, &parser, incrementalAfter);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(incremental.reparsedCount, 1);
+    parseWavefrontObjectFromString(&full, (char*)incrementalAfter);
+    assertIntegersEqual(wavefrontObjectEqual(&incremental.obj, &full), 1);
+    // second's leading face keeps green, blue moved to the end of the table.
+    assertIntegersEqual(incremental.obj.objects[1].faces[0].material, 1);
+    assertIntegersEqual(incremental.obj.objects[1].faces[1].material, 2);
+    assertFloatsEqual(incremental.obj.vertices[4].z, 1.0);
+    wavefrontObjectRelease(&full);
+
+    // Unchanged input copies every section.
+    result = wavefrontObjectIncrementalLoad(&incremental, &parser, incrementalAfter);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(incremental.reparsedCount, 0);
+    parseWavefrontObjectFromString(&full, (char*)incrementalAfter);
+    assertIntegersEqual(wavefrontObjectEqual(&incremental.obj, &full), 1);
+    wavefrontObjectRelease(&full);
+
+    wavefrontObjectIncrementalRelease(&incremental);
+    wavefrontObjectParserRelease(&parser);
+}
+
+void incrementalKeepsPreviousLoadOnError() {
+    struct WavefrontObjectParser parser;
+    struct WavefrontObjectIncremental incremental;
+    wavefrontObjectParserCompose(&parser);
+    wavefrontObjectIncrementalCompose(&incremental);
+    wavefrontObjectIncrementalLoad(&incremental, &parser, incrementalBefore);
+
+    const char broken[] = "o first\nv 0 0 0\no second\nv 1 2\n";
+    int result = wavefrontObjectIncrementalLoad(&incremental, &parser, broken);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(parser.diagnostic.line, 4);
+    assertIntegersEqual(incremental.obj.vertexCount, 5);
+    assertIntegersEqual(incremental.sectionCount, 4);
+
+    // Lines ended by lone CRs are numbered the same across sections.
+    const char brokenCr[] = "o first\rv 0 0 0\r\no second\rv 1 2\r";
+    result = wavefrontObjectIncrementalLoad(&incremental, &parser, brokenCr);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(parser.diagnostic.line, 4);
+
+    wavefrontObjectIncrementalRelease(&incremental);
+    wavefrontObjectParserRelease(&parser);
+}
+
+void incrementalVerifiesSectionBytes() {
+    const char before[] = "o a\nv 1 0 0\no b\nv 2 0 0\n";
+    const char after[] = "o a\nv 1 0 0\no b\nv 3 0 0\n";
+    struct WavefrontObjectParser parser;
+    struct WavefrontObjectIncremental incremental, other;
+    wavefrontObjectParserCompose(&parser);
+    wavefrontObjectIncrementalCompose(&incremental);
+    wavefrontObjectIncrementalCompose(&other);
+    wavefrontObjectIncrementalLoad(&incremental, &parser, before);
+    wavefrontObjectIncrementalLoad(&other, &parser, after);
+
+    // Forge a hash collision between the old and new b sections.
+    incremental.sections[1].hash = other.sections[1].hash;
+    int result = wavefrontObjectIncrementalLoad(&incremental, &parser, after);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(incremental.reparsedCount, 1);
+    assertFloatsEqual(incremental.obj.vertices[1].x, 3.0);
+
+    wavefrontObjectIncrementalRelease(&other);
+    wavefrontObjectIncrementalRelease(&incremental);
+    wavefrontObjectParserRelease(&parser);
+}
+
+void wavefrontObjectIncrementalTest() {
+    incrementalReparsesChangedSections();
+    incrementalKeepsPreviousLoadOnError();
+    incrementalVerifiesSectionBytes();
+}
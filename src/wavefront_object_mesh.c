@@ -0,0 +1,468 @@
+#include <stdlib.h>
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_mesh.h"
+
+#define MESH_NONE ((WavefrontObjectCount)-1)
+
+#define MESH_VERTEX 0
+#define MESH_UNWRAP 1
+#define MESH_NORMAL 2
+#define MESH_MATERIAL 3
+#define MESH_KINDS 4
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static int addCount(WavefrontObjectCount *total, WavefrontObjectCount count) {
+    if(count > (WavefrontObjectCount)WAVEFRONT_OBJECT_COUNT_MAX - *total) return STATUS_ALLOC_ERR;
+    *total += count;
+    return STATUS_OK;
+}
+
+static int inRange(WavefrontObjectIndex index, WavefrontObjectCount count) {
+    return index >= 1 && (WavefrontObjectCount)index <= count;
+}
+
+static WavefrontObjectIndex *pointIndex(struct WavefrontObjectPoint *point, int kind) {
+    if(kind == MESH_VERTEX) return &point->v;
+    if(kind == MESH_UNWRAP) return &point->vt;
+    return &point->vn;
+}
+
+// Copy a face into dst with its points in an exactly sized array of its own.
+static int copyFace(struct WavefrontObjectFace *dst, const struct WavefrontObjectFace *src) {
+    dst->points = (struct WavefrontObjectPoint*)malloc(src->pointCount * sizeof(struct WavefrontObjectPoint) + 1);
+    if(dst->points == NULL) return STATUS_ALLOC_ERR;
+    if(src->pointCount) memcpy(dst->points, src->points, src->pointCount * sizeof(struct WavefrontObjectPoint));
+    dst->pointCount = src->pointCount;
+    dst->pointCapacity = src->pointCount;
+    dst->material = src->material;
+    return STATUS_OK;
+}
+
+// Start the next object of out as a copy of name with room for faceCount faces.
+static struct WavefrontObjectObject *beginObject(struct WavefrontObject *out, const char *name, WavefrontObjectCount faceCount) {
+    struct WavefrontObjectObject *o = out->objects + out->objectCount;
+    o->name = strCopy(name);
+    if(o->name == NULL) return NULL;
+    out->objectCount++;
+    o->faces = (struct WavefrontObjectFace*)calloc(faceCount + 1, sizeof(struct WavefrontObjectFace));
+    if(o->faces == NULL) return NULL;
+    o->faceCapacity = faceCount;
+    return o;
+}
+
+// The object is left as if parsed, current object and material those of its last face.
+static void finishObject(struct WavefrontObject *out, WavefrontObjectCount lastMaterial) {
+    out->currentObject = out->objectCount ? (WavefrontObjectIndex)out->objectCount - 1 : -1;
+    out->currentMaterial = lastMaterial == MESH_NONE ? -1 : (WavefrontObjectIndex)lastMaterial;
+}
+
+static unsigned long long hashName(const char *name) {
+    unsigned long long hash = FNV_OFFSET;
+    for(; *name; name++) hash = (hash ^ (unsigned char)*name) * FNV_PRIME;
+    return hash;
+}
+
+// Index of name in names, appending a copy when it is not there yet. table
+// holds index + 1 per slot, open addressed over mask + 1 slots.
+static int internName(
+        char **names,
+        WavefrontObjectCount *count,
+        WavefrontObjectCount *table,
+        WavefrontObjectCount mask,
+        const char *name,
+        WavefrontObjectCount *index) {
+    WavefrontObjectCount slot = hashName(name) & mask;
+    for(; table[slot]; slot = (slot + 1) & mask) {
+        if(strcmp(names[table[slot] - 1], name) == 0) {
+            *index = table[slot] - 1;
+            return STATUS_OK;
+        }
+    }
+    names[*count] = strCopy(name);
+    if(names[*count] == NULL) return STATUS_ALLOC_ERR;
+    *index = (*count)++;
+    table[slot] = *count;
+    return STATUS_OK;
+}
+
+static int mergeInto(
+        struct WavefrontObject *out,
+        const struct WavefrontObject *objs,
+        WavefrontObjectCount count,
+        WavefrontObjectCount *table,
+        WavefrontObjectCount mask,
+        WavefrontObjectCount *materialMap) {
+    WavefrontObjectCount library;
+    for(WavefrontObjectCount i = 0; i < count; i++) {
+        for(WavefrontObjectCount j = 0; j < objs[i].materialLibraryCount; j++) {
+            if(internName(out->materialLibraries, &out->materialLibraryCount, table, mask, objs[i].materialLibraries[j], &library)) {
+                return STATUS_ALLOC_ERR;
+            }
+        }
+    }
+    memset(table, 0, (mask + 1) * sizeof(WavefrontObjectCount));
+    WavefrontObjectCount *map = materialMap;
+    for(WavefrontObjectCount i = 0; i < count; i++) {
+        for(WavefrontObjectCount j = 0; j < objs[i].materialCount; j++) {
+            if(internName(out->materials, &out->materialCount, table, mask, objs[i].materials[j], map++)) {
+                return STATUS_ALLOC_ERR;
+            }
+        }
+    }
+
+    WavefrontObjectCount lastMaterial = MESH_NONE;
+    for(WavefrontObjectCount i = 0; i < count; i++) {
+        const struct WavefrontObject *obj = objs + i;
+        WavefrontObjectCount bases[3] = {out->vertexCount, out->unwrapCount, out->normalCount};
+        WavefrontObjectCount counts[3] = {obj->vertexCount, obj->unwrapCount, obj->normalCount};
+        if(obj->vertexCount) memcpy(out->vertices + out->vertexCount, obj->vertices, obj->vertexCount * sizeof(struct WavefrontObjectVertex));
+        if(obj->unwrapCount) memcpy(out->unwraps + out->unwrapCount, obj->unwraps, obj->unwrapCount * sizeof(struct WavefrontObjectUnwrap));
+        if(obj->normalCount) memcpy(out->normals + out->normalCount, obj->normals, obj->normalCount * sizeof(struct WavefrontObjectNormal));
+        out->vertexCount += obj->vertexCount;
+        out->unwrapCount += obj->unwrapCount;
+        out->normalCount += obj->normalCount;
+
+        for(WavefrontObjectCount j = 0; j < obj->objectCount; j++) {
+            const struct WavefrontObjectObject *src = obj->objects + j;
+            struct WavefrontObjectObject *o = beginObject(out, src->name, src->faceCount);
+            if(o == NULL) return STATUS_ALLOC_ERR;
+            for(; o->faceCount < src->faceCount; o->faceCount++) {
+                struct WavefrontObjectFace *face = o->faces + o->faceCount;
+                if(copyFace(face, src->faces + o->faceCount)) return STATUS_ALLOC_ERR;
+                for(WavefrontObjectCount k = 0; k < face->pointCount; k++) {
+                    for(int kind = MESH_VERTEX; kind <= MESH_NORMAL; kind++) {
+                        WavefrontObjectIndex *index = pointIndex(face->points + k, kind);
+                        if(inRange(*index, counts[kind])) *index += (WavefrontObjectIndex)bases[kind];
+                    }
+                }
+                face->material = face->material < obj->materialCount ? materialMap[face->material] : MESH_NONE;
+                lastMaterial = face->material;
+            }
+        }
+        materialMap += obj->materialCount;
+    }
+    finishObject(out, lastMaterial);
+    return STATUS_OK;
+}
+
+int wavefrontObjectMerge(struct WavefrontObject *out, const struct WavefrontObject *objs, WavefrontObjectCount count) {
+    wavefrontObjectCompose(out);
+    WavefrontObjectCount libraryTotal = 0, materialTotal = 0, objectTotal = 0;
+    WavefrontObjectCount vertexTotal = 0, unwrapTotal = 0, normalTotal = 0;
+    for(WavefrontObjectCount i = 0; i < count; i++) {
+        if(addCount(&libraryTotal, objs[i].materialLibraryCount)
+                || addCount(&materialTotal, objs[i].materialCount)
+                || addCount(&objectTotal, objs[i].objectCount)
+                || addCount(&vertexTotal, objs[i].vertexCount)
+                || addCount(&unwrapTotal, objs[i].unwrapCount)
+                || addCount(&normalTotal, objs[i].normalCount)) {
+            return STATUS_ALLOC_ERR;
+        }
+    }
+
+    // One name table, sized for the longer of the two name lists, serves both.
+    WavefrontObjectCount tableSize = 2;
+    while(tableSize <= (libraryTotal > materialTotal ? libraryTotal : materialTotal)) tableSize *= 2;
+    tableSize *= 2;
+    WavefrontObjectCount *scratch = (WavefrontObjectCount*)calloc(tableSize + materialTotal, sizeof(WavefrontObjectCount));
+    char **libraries = (char**)calloc(libraryTotal + 1, sizeof(char*));
+    char **materials = (char**)calloc(materialTotal + 1, sizeof(char*));
+    struct WavefrontObjectObject *objects = (struct WavefrontObjectObject*)calloc(objectTotal + 1, sizeof(struct WavefrontObjectObject));
+    struct WavefrontObjectVertex *vertices = (struct WavefrontObjectVertex*)malloc(vertexTotal * sizeof(struct WavefrontObjectVertex) + 1);
+    struct WavefrontObjectUnwrap *unwraps = (struct WavefrontObjectUnwrap*)malloc(unwrapTotal * sizeof(struct WavefrontObjectUnwrap) + 1);
+    struct WavefrontObjectNormal *normals = (struct WavefrontObjectNormal*)malloc(normalTotal * sizeof(struct WavefrontObjectNormal) + 1);
+    if(!scratch || !libraries || !materials || !objects || !vertices || !unwraps || !normals) {
+        free(scratch);
+        free(libraries);
+        free(materials);
+        free(objects);
+        free(vertices);
+        free(unwraps);
+        free(normals);
+        return STATUS_ALLOC_ERR;
+    }
+    out->materialLibraries = libraries;
+    out->materials = materials;
+    out->objects = objects;
+    out->vertices = vertices;
+    out->unwraps = unwraps;
+    out->normals = normals;
+    out->materialLibraryCapacity = libraryTotal;
+    out->materialCapacity = materialTotal;
+    out->objectCapacity = objectTotal;
+    out->vertexCapacity = vertexTotal;
+    out->unwrapCapacity = unwrapTotal;
+    out->normalCapacity = normalTotal;
+
+    int result = mergeInto(out, objs, count, scratch, tableSize - 1, scratch + tableSize);
+    free(scratch);
+    if(result) wavefrontObjectRelease(out);
+    return result;
+}
+
+// Per element kind, the part that last used each element and its index there.
+// Stamping with the part index spares clearing the maps between parts.
+struct SplitMaps {
+    WavefrontObjectCount *owner[MESH_KINDS];
+    WavefrontObjectCount *remap[MESH_KINDS];
+};
+
+static int composeMaps(struct SplitMaps *maps, const struct WavefrontObject *obj) {
+    WavefrontObjectCount counts[MESH_KINDS] = {obj->vertexCount, obj->unwrapCount, obj->normalCount, obj->materialCount};
+    size_t total = 0;
+    for(int kind = 0; kind < MESH_KINDS; kind++) total += counts[kind];
+    WavefrontObjectCount *data = (WavefrontObjectCount*)malloc(2 * total * sizeof(WavefrontObjectCount) + 1);
+    if(data == NULL) return STATUS_ALLOC_ERR;
+    memset(data, 0xff, total * sizeof(WavefrontObjectCount));
+    for(int kind = 0; kind < MESH_KINDS; kind++) {
+        maps->owner[kind] = data;
+        maps->remap[kind] = data + total;
+        data += counts[kind];
+    }
+    return STATUS_OK;
+}
+
+static void releaseMaps(struct SplitMaps *maps) {
+    free(maps->owner[0]);
+}
+
+static void claim(struct SplitMaps *maps, int kind, WavefrontObjectCount element, WavefrontObjectCount part, WavefrontObjectCount *count) {
+    if(maps->owner[kind][element] == part) return;
+    maps->owner[kind][element] = part;
+    maps->remap[kind][element] = (*count)++;
+}
+
+// Fill part with the faces refs point at, runs of faces from the same object
+// becoming one object, and only the elements those faces use.
+static int buildPart(
+        struct WavefrontObject *part,
+        const struct WavefrontObject *obj,
+        const struct WavefrontObjectFaceRef *refs,
+        WavefrontObjectCount refCount,
+        struct SplitMaps *maps,
+        WavefrontObjectCount stamp) {
+    WavefrontObjectCount limits[MESH_KINDS] = {obj->vertexCount, obj->unwrapCount, obj->normalCount, obj->materialCount};
+    WavefrontObjectCount counts[MESH_KINDS] = {0, 0, 0, 0}, objectCount = 0;
+    for(WavefrontObjectCount r = 0; r < refCount; r++) {
+        if(r == 0 || refs[r].object != refs[r - 1].object) objectCount++;
+        const struct WavefrontObjectFace *face = obj->objects[refs[r].object].faces + refs[r].face;
+        for(WavefrontObjectCount k = 0; k < face->pointCount; k++) {
+            for(int kind = MESH_VERTEX; kind <= MESH_NORMAL; kind++) {
+                WavefrontObjectIndex index = *pointIndex(face->points + k, kind);
+                if(inRange(index, limits[kind])) claim(maps, kind, index - 1, stamp, counts + kind);
+            }
+        }
+        if(face->material < limits[MESH_MATERIAL]) claim(maps, MESH_MATERIAL, face->material, stamp, counts + MESH_MATERIAL);
+    }
+
+    char **libraries = (char**)calloc(obj->materialLibraryCount + 1, sizeof(char*));
+    char **materials = (char**)calloc(counts[MESH_MATERIAL] + 1, sizeof(char*));
+    struct WavefrontObjectObject *objects = (struct WavefrontObjectObject*)calloc(objectCount + 1, sizeof(struct WavefrontObjectObject));
+    struct WavefrontObjectVertex *vertices = (struct WavefrontObjectVertex*)malloc(counts[MESH_VERTEX] * sizeof(struct WavefrontObjectVertex) + 1);
+    struct WavefrontObjectUnwrap *unwraps = (struct WavefrontObjectUnwrap*)malloc(counts[MESH_UNWRAP] * sizeof(struct WavefrontObjectUnwrap) + 1);
+    struct WavefrontObjectNormal *normals = (struct WavefrontObjectNormal*)malloc(counts[MESH_NORMAL] * sizeof(struct WavefrontObjectNormal) + 1);
+    if(!libraries || !materials || !objects || !vertices || !unwraps || !normals) {
+        free(libraries);
+        free(materials);
+        free(objects);
+        free(vertices);
+        free(unwraps);
+        free(normals);
+        return STATUS_ALLOC_ERR;
+    }
+    part->materialLibraries = libraries;
+    part->materials = materials;
+    part->objects = objects;
+    part->vertices = vertices;
+    part->unwraps = unwraps;
+    part->normals = normals;
+    part->materialLibraryCapacity = obj->materialLibraryCount;
+    part->materialCapacity = counts[MESH_MATERIAL];
+    part->objectCapacity = objectCount;
+    part->vertexCount = part->vertexCapacity = counts[MESH_VERTEX];
+    part->unwrapCount = part->unwrapCapacity = counts[MESH_UNWRAP];
+    part->normalCount = part->normalCapacity = counts[MESH_NORMAL];
+
+    for(; part->materialLibraryCount < obj->materialLibraryCount; part->materialLibraryCount++) {
+        libraries[part->materialLibraryCount] = strCopy(obj->materialLibraries[part->materialLibraryCount]);
+        if(libraries[part->materialLibraryCount] == NULL) return STATUS_ALLOC_ERR;
+    }
+
+    WavefrontObjectCount lastMaterial = MESH_NONE;
+    for(WavefrontObjectCount r = 0, runEnd; r < refCount; r = runEnd) {
+        for(runEnd = r + 1; runEnd < refCount && refs[runEnd].object == refs[r].object; runEnd++);
+        struct WavefrontObjectObject *o = beginObject(part, obj->objects[refs[r].object].name, runEnd - r);
+        if(o == NULL) return STATUS_ALLOC_ERR;
+        for(; r < runEnd; r++, o->faceCount++) {
+            struct WavefrontObjectFace *face = o->faces + o->faceCount;
+            if(copyFace(face, obj->objects[refs[r].object].faces + refs[r].face)) return STATUS_ALLOC_ERR;
+            for(WavefrontObjectCount k = 0; k < face->pointCount; k++) {
+                struct WavefrontObjectPoint *point = face->points + k;
+                if(inRange(point->v, limits[MESH_VERTEX])) {
+                    WavefrontObjectCount element = point->v - 1, remapped = maps->remap[MESH_VERTEX][element];
+                    vertices[remapped] = obj->vertices[element];
+                    point->v = remapped + 1;
+                }
+                if(inRange(point->vt, limits[MESH_UNWRAP])) {
+                    WavefrontObjectCount element = point->vt - 1, remapped = maps->remap[MESH_UNWRAP][element];
+                    unwraps[remapped] = obj->unwraps[element];
+                    point->vt = remapped + 1;
+                }
+                if(inRange(point->vn, limits[MESH_NORMAL])) {
+                    WavefrontObjectCount element = point->vn - 1, remapped = maps->remap[MESH_NORMAL][element];
+                    normals[remapped] = obj->normals[element];
+                    point->vn = remapped + 1;
+                }
+            }
+            if(face->material < limits[MESH_MATERIAL]) {
+                WavefrontObjectCount remapped = maps->remap[MESH_MATERIAL][face->material];
+                if(materials[remapped] == NULL) {
+                    materials[remapped] = strCopy(obj->materials[face->material]);
+                    if(materials[remapped] == NULL) return STATUS_ALLOC_ERR;
+                }
+                face->material = remapped;
+            } else {
+                face->material = MESH_NONE;
+            }
+            lastMaterial = face->material;
+        }
+    }
+    part->materialCount = counts[MESH_MATERIAL];
+    finishObject(part, lastMaterial);
+    return STATUS_OK;
+}
+
+static int composeParts(struct WavefrontObject **parts, WavefrontObjectCount partCount) {
+    *parts = (struct WavefrontObject*)malloc(partCount * sizeof(struct WavefrontObject) + 1);
+    if(*parts == NULL) return STATUS_ALLOC_ERR;
+    for(WavefrontObjectCount i = 0; i < partCount; i++) wavefrontObjectCompose(*parts + i);
+    return STATUS_OK;
+}
+
+int wavefrontObjectSplitByObject(struct WavefrontObject **parts, WavefrontObjectCount *partCount, const struct WavefrontObject *obj) {
+    *parts = NULL;
+    *partCount = 0;
+    WavefrontObjectCount faceMost = 0;
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        if(obj->objects[i].faceCount > faceMost) faceMost = obj->objects[i].faceCount;
+    }
+    struct SplitMaps maps;
+    if(composeMaps(&maps, obj)) return STATUS_ALLOC_ERR;
+    struct WavefrontObjectFaceRef *refs = (struct WavefrontObjectFaceRef*)malloc(faceMost * sizeof(struct WavefrontObjectFaceRef) + 1);
+    if(refs == NULL || composeParts(parts, obj->objectCount)) {
+        free(refs);
+        releaseMaps(&maps);
+        return STATUS_ALLOC_ERR;
+    }
+    *partCount = obj->objectCount;
+
+    int result = STATUS_OK;
+    for(WavefrontObjectCount i = 0; result == STATUS_OK && i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            refs[j].object = i;
+            refs[j].face = j;
+        }
+        result = buildPart(*parts + i, obj, refs, o->faceCount, &maps, i);
+        // An object without faces still names its part.
+        if(result == STATUS_OK && o->faceCount == 0) result = wavefrontObjectAddObject(*parts + i, o->name);
+    }
+    free(refs);
+    releaseMaps(&maps);
+    if(result) {
+        wavefrontObjectSplitRelease(*parts, *partCount);
+        *parts = NULL;
+        *partCount = 0;
+    }
+    return result;
+}
+
+int wavefrontObjectSplitByMaterial(struct WavefrontObject **parts, WavefrontObjectCount *partCount, const struct WavefrontObject *obj) {
+    *parts = NULL;
+    *partCount = 0;
+    struct WavefrontObjectMaterialGroups groups;
+    if(wavefrontObjectGroupByMaterial(&groups, obj)) return STATUS_ALLOC_ERR;
+    struct SplitMaps maps;
+    if(composeMaps(&maps, obj)) {
+        wavefrontObjectMaterialGroupsRelease(&groups);
+        return STATUS_ALLOC_ERR;
+    }
+    int result = composeParts(parts, groups.groupCount);
+    if(result == STATUS_OK) *partCount = groups.groupCount;
+    for(WavefrontObjectCount i = 0; result == STATUS_OK && i < groups.groupCount; i++) {
+        const struct WavefrontObjectMaterialGroup *group = groups.groups + i;
+        result = buildPart(*parts + i, obj, groups.faces + group->faceStart, group->faceCount, &maps, i);
+    }
+    releaseMaps(&maps);
+    wavefrontObjectMaterialGroupsRelease(&groups);
+    if(result) {
+        wavefrontObjectSplitRelease(*parts, *partCount);
+        *parts = NULL;
+        *partCount = 0;
+    }
+    return result;
+}
+
+void wavefrontObjectSplitRelease(struct WavefrontObject *parts, WavefrontObjectCount partCount) {
+    for(WavefrontObjectCount i = 0; i < partCount; i++) wavefrontObjectRelease(parts + i);
+    free(parts);
+}
+
+// A counting sort of every face by material. Groups start as one per
+// material plus one for faces without, the empty ones are dropped at the end.
+int wavefrontObjectGroupByMaterial(struct WavefrontObjectMaterialGroups *groups, const struct WavefrontObject *obj) {
+    memset(groups, 0, sizeof(struct WavefrontObjectMaterialGroups));
+    WavefrontObjectCount faceTotal = 0, keyCount = obj->materialCount + 1;
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        if(addCount(&faceTotal, obj->objects[i].faceCount)) return STATUS_ALLOC_ERR;
+    }
+    size_t groupSize = keyCount * sizeof(struct WavefrontObjectMaterialGroup);
+    if(faceTotal > ((size_t)-1 - groupSize) / sizeof(struct WavefrontObjectFaceRef)) return STATUS_ALLOC_ERR;
+    struct WavefrontObjectMaterialGroup *keyed = (struct WavefrontObjectMaterialGroup*)calloc(
+        1,
+        groupSize + faceTotal * sizeof(struct WavefrontObjectFaceRef));
+    if(keyed == NULL) return STATUS_ALLOC_ERR;
+    struct WavefrontObjectFaceRef *faces = (struct WavefrontObjectFaceRef*)(keyed + keyCount);
+
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            struct WavefrontObjectMaterialGroup *group = keyed + (face->material < obj->materialCount ? face->material : obj->materialCount);
+            group->faceCount++;
+            group->pointCount += face->pointCount;
+        }
+    }
+    WavefrontObjectCount start = 0;
+    for(WavefrontObjectCount key = 0; key < keyCount; key++) {
+        keyed[key].material = key < obj->materialCount ? key : MESH_NONE;
+        keyed[key].faceStart = start;
+        start += keyed[key].faceCount;
+        // Counts again as faces are placed.
+        keyed[key].faceCount = 0;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            struct WavefrontObjectMaterialGroup *group = keyed + (face->material < obj->materialCount ? face->material : obj->materialCount);
+            struct WavefrontObjectFaceRef *ref = faces + group->faceStart + group->faceCount++;
+            ref->object = i;
+            ref->face = j;
+        }
+    }
+    for(WavefrontObjectCount key = 0; key < keyCount; key++) {
+        if(keyed[key].faceCount) keyed[groups->groupCount++] = keyed[key];
+    }
+    groups->groups = keyed;
+    groups->faces = faces;
+    groups->faceCount = faceTotal;
+    return STATUS_OK;
+}
+
+void wavefrontObjectMaterialGroupsRelease(struct WavefrontObjectMaterialGroups *groups) {
+    free(groups->groups);
+}
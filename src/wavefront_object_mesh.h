@@ -0,0 +1,54 @@
+#ifndef __WAVEFRONT_OBJECT_MESH_H
+#define __WAVEFRONT_OBJECT_MESH_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+
+// objects[object].faces[face] of the grouped object.
+struct WavefrontObjectFaceRef {
+    WavefrontObjectCount object;
+    WavefrontObjectCount face;
+};
+
+// A draw batch, faces[faceStart] to faces[faceStart + faceCount - 1] all use
+// material, which is (WavefrontObjectCount)-1 for faces without one.
+// pointCount sums their points to size an index buffer up front.
+struct WavefrontObjectMaterialGroup {
+    WavefrontObjectCount material;
+    WavefrontObjectCount faceStart;
+    WavefrontObjectCount faceCount;
+    WavefrontObjectCount pointCount;
+};
+
+// Groups in material order with faces without a material last, each keeping
+// the order its faces had in the object. Materials no face uses get no group.
+// groups and faces share one allocation.
+struct WavefrontObjectMaterialGroups {
+    struct WavefrontObjectMaterialGroup *groups;
+    struct WavefrontObjectFaceRef *faces;
+    WavefrontObjectCount groupCount;
+    WavefrontObjectCount faceCount;
+};
+
+// Append every object of objs into out. Face indices are rebased onto the
+// merged vertices, unwraps and normals, materials and material libraries are
+// merged by name. Indices outside 1 to the element count, relative negative
+// ones included, are copied unchanged.
+int wavefrontObjectMerge(struct WavefrontObject *out, const struct WavefrontObject *objs, WavefrontObjectCount count);
+
+// Split obj into *partCount standalone objects, one per object or one per
+// material group. Each part holds only the elements its faces use, reindexed,
+// and every material library. Free the parts with wavefrontObjectSplitRelease.
+int wavefrontObjectSplitByObject(struct WavefrontObject **parts, WavefrontObjectCount *partCount, const struct WavefrontObject *obj);
+int wavefrontObjectSplitByMaterial(struct WavefrontObject **parts, WavefrontObjectCount *partCount, const struct WavefrontObject *obj);
+void wavefrontObjectSplitRelease(struct WavefrontObject *parts, WavefrontObjectCount partCount);
+
+int wavefrontObjectGroupByMaterial(struct WavefrontObjectMaterialGroups *groups, const struct WavefrontObject *obj);
+void wavefrontObjectMaterialGroupsRelease(struct WavefrontObjectMaterialGroups *groups);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,224 @@
+#include "wavefront_object_mesh.h"
+#include "wavefront_object_parser.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+static const char meshInput[] = "\
+mtllib scene.mtl\n\
+o left\n\
+v 0 0 0\n\
+v 1 0 0\n\
+v 1 1 0\n\
+v 0 1 0\n\
+vt 0 0\n\
+usemtl red\n\
+f 1/1 2/1 3/1\n\
+usemtl blue\n\
+f 1/1 3/1 4/1\n\
+o right\n\
+v 5 5 5\n\
+v 6 5 5\n\
+v 6 6 5\n\
+usemtl red\n\
+f 5 6 7\n\
+f 5 -1 7\n";
+
+void meshMergeRebasesIndices() {
+    char second[] = "\
+    mtllib scene.mtl other.mtl\n\
+    v 9 9 9\n\
+    vn 0 0 1\n\
+    f 1//1 1//1 1//1\n\
+    usemtl blue\n\
+    o tail\n\
+    f 1//1 1//1 1//1 0\n";
+    struct WavefrontObject wObjs[2], merged;
+    parseWavefrontObjectFromString(wObjs, (char*)meshInput);
+    parseWavefrontObjectFromString(wObjs + 1, second);
+    int result = wavefrontObjectMerge(&merged, wObjs, 2);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(merged.vertexCount, 8);
+    assertIntegersEqual(merged.unwrapCount, 1);
+    assertIntegersEqual(merged.normalCount, 1);
+    assertFloatsEqual(merged.vertices[7].x, 9.0);
+    assertIntegersEqual(merged.materialLibraryCount, 2);
+    assertStringsEqual(merged.materialLibraries[1], "other.mtl");
+    assertIntegersEqual(merged.materialCount, 2);
+    assertIntegersEqual(merged.objectCount, 4);
+    assertStringsEqual(merged.objects[2].name, "");
+    assertStringsEqual(merged.objects[3].name, "tail");
+
+    // Relative and missing indices are left alone.
+    struct WavefrontObjectFace *face = merged.objects[1].faces + 1;
+    assertIntegersEqual(face->points[1].v, -1);
+    assertIntegersEqual(face->points[2].v, 7);
+    face = merged.objects[2].faces;
+    assertIntegersEqual(face->points[0].v, 8);
+    assertIntegersEqual(face->points[0].vt, 0);
+    assertIntegersEqual(face->points[0].vn, 1);
+    assertIntegersEqual(face->material, (WavefrontObjectCount)-1);
+    face = merged.objects[3].faces;
+    assertIntegersEqual(face->material, 1);
+    assertIntegersEqual(face->points[3].v, 0);
+    assertIntegersEqual(merged.currentMaterial, 1);
+    assertIntegersEqual(merged.currentObject, 3);
+
+    wavefrontObjectRelease(&merged);
+    wavefrontObjectRelease(wObjs);
+    wavefrontObjectRelease(wObjs + 1);
+}
+
+void meshGroupByMaterial() {
+    char input[] = "\
+    v 0 0 0\n\
+    f 1 1 1\n\
+    usemtl red\n\
+    f 1 1 1 1\n\
+    usemtl unused\n\
+    usemtl blue\n\
+    o next\n\
+    f 1 1 1\n\
+    usemtl red\n\
+    f 1 1 1 1 1\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectMaterialGroups groups;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectGroupByMaterial(&groups, &wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(groups.faceCount, 4);
+    assertIntegersEqual(groups.groupCount, 3);
+    assertIntegersEqual(groups.groups[0].material, 0);
+    assertIntegersEqual(groups.groups[0].faceCount, 2);
+    assertIntegersEqual(groups.groups[0].pointCount, 9);
+    assertIntegersEqual(groups.groups[1].material, 2);
+    assertIntegersEqual(groups.groups[1].faceStart, 2);
+    assertIntegersEqual(groups.groups[2].material, (WavefrontObjectCount)-1);
+    assertIntegersEqual(groups.groups[2].faceStart, 3);
+
+    // Faces keep their order within a group.
+    assertIntegersEqual(groups.faces[0].object, 0);
+    assertIntegersEqual(groups.faces[0].face, 1);
+    assertIntegersEqual(groups.faces[1].object, 1);
+    assertIntegersEqual(groups.faces[1].face, 1);
+    assertIntegersEqual(groups.faces[3].face, 0);
+    wavefrontObjectMaterialGroupsRelease(&groups);
+    wavefrontObjectRelease(&wObj);
+}
+
+void meshSplitByObject() {
+    struct WavefrontObject wObj, *parts;
+    WavefrontObjectCount partCount;
+    parseWavefrontObjectFromString(&wObj, (char*)meshInput);
+    int result = wavefrontObjectSplitByObject(&parts, &partCount, &wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(partCount, 2);
+
+    assertIntegersEqual(parts[0].vertexCount, 4);
+    assertIntegersEqual(parts[0].unwrapCount, 1);
+    assertIntegersEqual(parts[0].materialCount, 2);
+    assertIntegersEqual(parts[0].materialLibraryCount, 1);
+    assertStringsEqual(parts[0].objects->name, "left");
+
+    // Only the vertices it uses, renumbered from one.
+    assertIntegersEqual(parts[1].vertexCount, 3);
+    assertIntegersEqual(parts[1].unwrapCount, 0);
+    assertIntegersEqual(parts[1].materialCount, 1);
+    assertStringsEqual(parts[1].materials[0], "red");
+    assertStringsEqual(parts[1].materialLibraries[0], "scene.mtl");
+    struct WavefrontObjectFace *face = parts[1].objects->faces;
+    assertIntegersEqual(face->points[0].v, 1);
+    assertIntegersEqual(face->points[2].v, 3);
+    assertIntegersEqual(face->material, 0);
+    assertFloatsEqual(parts[1].vertices[1].x, 6.0);
+    assertIntegersEqual(face[1].points[1].v, -1);
+    wavefrontObjectSplitRelease(parts, partCount);
+    wavefrontObjectRelease(&wObj);
+}
+
+void meshSplitByMaterial() {
+    struct WavefrontObject wObj, *parts;
+    WavefrontObjectCount partCount;
+    parseWavefrontObjectFromString(&wObj, (char*)meshInput);
+    int result = wavefrontObjectSplitByMaterial(&parts, &partCount, &wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(partCount, 2);
+
+    // Red spans both objects.
+    assertIntegersEqual(parts[0].objectCount, 2);
+    assertStringsEqual(parts[0].objects[1].name, "right");
+    assertIntegersEqual(parts[0].objects[0].faceCount, 1);
+    assertIntegersEqual(parts[0].objects[1].faceCount, 2);
+    assertIntegersEqual(parts[0].vertexCount, 6);
+    assertIntegersEqual(parts[0].materialCount, 1);
+    assertStringsEqual(parts[0].materials[0], "red");
+
+    assertIntegersEqual(parts[1].objectCount, 1);
+    assertIntegersEqual(parts[1].vertexCount, 3);
+    assertStringsEqual(parts[1].materials[0], "blue");
+    assertIntegersEqual(parts[1].currentMaterial, 0);
+    struct WavefrontObjectPoint *points = parts[1].objects->faces->points;
+    assertIntegersEqual(points[0].v, 1);
+    assertIntegersEqual(points[1].v, 2);
+    assertIntegersEqual(points[2].v, 3);
+    assertFloatsEqual(parts[1].vertices[2].y, 1.0);
+    wavefrontObjectSplitRelease(parts, partCount);
+    wavefrontObjectRelease(&wObj);
+}
+
+// Objects with vertices of their own split apart and merge back unchanged.
+void meshSplitMergeRoundTrip() {
+    char input[] = "\
+    mtllib scene.mtl\n\
+    o first\n\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 0 1 0\n\
+    usemtl red\n\
+    f 1 2 3\n\
+    o empty\n\
+    o second\n\
+    v 2 0 0\n\
+    v 3 0 0\n\
+    v 2 1 0\n\
+    usemtl blue\n\
+    f 4 5 6\n";
+    struct WavefrontObject wObj, *parts, merged;
+    WavefrontObjectCount partCount;
+    parseWavefrontObjectFromString(&wObj, input);
+    wavefrontObjectSplitByObject(&parts, &partCount, &wObj);
+    assertIntegersEqual(partCount, 3);
+    assertIntegersEqual(parts[1].objectCount, 1);
+    assertStringsEqual(parts[1].objects->name, "empty");
+    int result = wavefrontObjectMerge(&merged, parts, partCount);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wavefrontObjectEqual(&wObj, &merged), 1);
+    wavefrontObjectRelease(&merged);
+    wavefrontObjectSplitRelease(parts, partCount);
+    wavefrontObjectRelease(&wObj);
+}
+
+void meshEmptyObject() {
+    struct WavefrontObject wObj, merged, *parts;
+    struct WavefrontObjectMaterialGroups groups;
+    WavefrontObjectCount partCount;
+    wavefrontObjectCompose(&wObj);
+    assertIntegersEqual(wavefrontObjectMerge(&merged, &wObj, 1), STATUS_OK);
+    assertIntegersEqual(wavefrontObjectEqual(&wObj, &merged), 1);
+    assertIntegersEqual(wavefrontObjectSplitByMaterial(&parts, &partCount, &wObj), STATUS_OK);
+    assertIntegersEqual(partCount, 0);
+    wavefrontObjectSplitRelease(parts, partCount);
+    assertIntegersEqual(wavefrontObjectGroupByMaterial(&groups, &wObj), STATUS_OK);
+    assertIntegersEqual(groups.groupCount, 0);
+    wavefrontObjectMaterialGroupsRelease(&groups);
+    wavefrontObjectRelease(&merged);
+    wavefrontObjectRelease(&wObj);
+}
+
+void wavefrontObjectMeshTest() {
+    meshMergeRebasesIndices();
+    meshGroupByMaterial();
+    meshSplitByObject();
+    meshSplitByMaterial();
+    meshSplitMergeRoundTrip();
+    meshEmptyObject();
+}
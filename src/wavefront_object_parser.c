@@ -1,10 +1,29 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
 #include "cutil/src/error.h"
 #include "cutil/src/string.h"
 #include "wavefront_object_parser.h"
+#include "wavefront_object_scan.h"
 
-static int parseVertex(struct WavefrontObject *obj, const char *line) {
+// Where parsed elements go, the callbacks with their context and the parser
+// whose scratch holds face points. Scans of the line may read up to limit, just
+// past its NUL. The parser's buffer is never initialised beyond that.
+// callbackFailed tells a failing callback apart from a malformed line.
+struct LineTarget {
+    struct WavefrontObjectParser *parser;
+    const struct WavefrontObjectCallbacks *callbacks;
+    void *context;
+    const char *limit;
+    int callbackFailed;
+};
+
+static int passOn(struct LineTarget *target, int result) {
+    target->callbackFailed = result != STATUS_OK;
+    return result;
+}
+
+static int parseVertex(struct LineTarget *target, const char *line, const char **position) {
     struct WavefrontObjectVertex vertex;
     vertex.w = 1.0;
     if(sscanf(
@@ -14,30 +33,30 @@ static int parseVertex(struct WavefrontObject *obj, const char *line) {
         &vertex.y,
         &vertex.z,
         &vertex.w) >= 3) {
-        return wavefrontObjectAddVertex(obj, &vertex);
+        return target->callbacks->onVertex ? passOn(target, target->callbacks->onVertex(target->context, &vertex)) : STATUS_OK;
     }
     return STATUS_PARSE_ERR;
 }
 
-static int parseUnwrap(struct WavefrontObject *obj, const char *line) {
+static int parseUnwrap(struct LineTarget *target, const char *line, const char **position) {
     struct WavefrontObjectUnwrap unwrap;
     unwrap.w = 0.0;
     if(sscanf(line, "%lf %lf %lf", &unwrap.u, &unwrap.v, &unwrap.w) >= 2) {
-        return wavefrontObjectAddUnwrap(obj, &unwrap);
+        return target->callbacks->onUnwrap ? passOn(target, target->callbacks->onUnwrap(target->context, &unwrap)) : STATUS_OK;
     }
     return STATUS_PARSE_ERR;
 }
 
-static int parseNormal(struct WavefrontObject *obj, const char *line) {
+static int parseNormal(struct LineTarget *target, const char *line, const char **position) {
     struct WavefrontObjectNormal normal;
     if(sscanf(line, "%lf %lf %lf", &normal.x, &normal.y, &normal.z) == 3) {
-        return wavefrontObjectAddNormal(obj, &normal);
+        return target->callbacks->onNormal ? passOn(target, target->callbacks->onNormal(target->context, &normal)) : STATUS_OK;
     }
     return STATUS_PARSE_ERR;
 }
 
 static int parsePoint(struct WavefrontObjectPoint *point, const char *input) {
-    unsigned int indicies[3] = {0, 0, 0}; // Vertex, UV, Normal.
+    WavefrontObjectIndex indicies[3] = {0, 0, 0}; // Vertex, UV, Normal.
     short i = 0;
     const char *thisToken = input, *nextDelim = NULL, *nextToken = NULL;
     const char *lastDelim = NULL;
@@ -49,7 +68,15 @@ static int parsePoint(struct WavefrontObjectPoint *point, const char *input) {
             indicies[i] = 0;
         }
         else if(strAfterInteger(thisToken) < nextDelim) return STATUS_PARSE_ERR; // Token is not an integer.
-        else indicies[i] = atoi(thisToken);
+        else {
+            errno = 0;
+            long long index = strtoll(thisToken, NULL, 10);
+            // Out of range for the index type.
+            if(errno == ERANGE || index > WAVEFRONT_OBJECT_COUNT_MAX || index < -WAVEFRONT_OBJECT_COUNT_MAX) {
+                return STATUS_PARSE_ERR;
+            }
+            indicies[i] = (WavefrontObjectIndex)index;
+        }
         lastDelim = nextDelim;
         i++;
     }
@@ -59,36 +86,64 @@ static int parsePoint(struct WavefrontObjectPoint *point, const char *input) {
     return STATUS_OK;
 }
 
-static int parseFace(struct WavefrontObject *obj, const char *line) {
-    struct WavefrontObjectFace face;
-    face.pointCount = 0;
-    face.points = NULL;
-    const char *thisToken = line, *nextDelim = NULL, *nextToken = NULL;
-    while(tokenize(&thisToken, &nextDelim, &nextToken, ASCII_H_DELIMITERS)) {
-        char *token = strCopyN(thisToken, nextDelim-thisToken);
+static int addPoint(struct WavefrontObjectParser *parser, WavefrontObjectCount count, struct WavefrontObjectPoint *point) {
+    if(count == parser->pointCapacity) {
+        WavefrontObjectCount capacity = parser->pointCapacity ? parser->pointCapacity * 2 : 16;
+        struct WavefrontObjectPoint *temp = (struct WavefrontObjectPoint*)realloc(
+            parser->points,
+            capacity * sizeof(struct WavefrontObjectPoint));
+        if(temp == NULL) return STATUS_ALLOC_ERR;
+        parser->points = temp;
+        parser->pointCapacity = capacity;
+    }
+    parser->points[count] = *point;
+    return STATUS_OK;
+}
+
+static int parseFace(struct LineTarget *target, const char *line, const char **position) {
+    // Points gather in the parser's scratch, the face is only passed on whole.
+    WavefrontObjectCount pointCount = 0;
+    const char *thisToken = line;
+    for(;;) {
+        const char *nextDelim = wavefrontObjectScanField(thisToken, target->limit);
+        // Points are short, only copy to the heap when one is not.
+        char buffer[32];
+        unsigned long length = nextDelim - thisToken;
+        char *token = length < sizeof(buffer) ? buffer : strCopyN(thisToken, length);
         if(!token) return STATUS_ALLOC_ERR;
+        if(token == buffer) {
+            memcpy(buffer, thisToken, length);
+            buffer[length] = '\0';
+        }
 
         struct WavefrontObjectPoint point;
         int result = parsePoint(&point, token);
         if(result == STATUS_OK) {
-            result = wavefrontObjectFaceAddPoint(&face, &point);
+            result = addPoint(target->parser, pointCount++, &point);
         }
 
-        free(token);
-        if(result) return result;
+        if(token != buffer) free(token);
+        if(result) {
+            *position = thisToken;
+            return result;
+        }
+        if(*nextDelim == '\0') break;
+        thisToken = nextDelim + 1;
     }
-    return face.pointCount ? wavefrontObjectAddFace(obj, &face) : STATUS_PARSE_ERR;
+    if(pointCount == 0) return STATUS_PARSE_ERR;
+    return target->callbacks->onFace ? passOn(target, target->callbacks->onFace(target->context, target->parser->points, pointCount)) : STATUS_OK;
 }
 
-static int parseMaterialLibrary(struct WavefrontObject *obj, const char *line) {
+static int parseMaterialLibrary(struct LineTarget *target, const char *line, const char **position) {
     int result = STATUS_PARSE_ERR;
     const char *thisToken = line, *nextDelim = NULL, *nextToken = NULL;
+    if(!target->callbacks->onMaterialLibrary) return STATUS_OK;
     // Remaining tokens are material library files.
     while(tokenize(&thisToken, &nextDelim, &nextToken, ASCII_H_DELIMITERS)) {
         if(thisToken==nextDelim) continue; // Ignore empty string tokens.
         char *token = strCopyN(thisToken, nextDelim-thisToken);
         if(!token) return STATUS_ALLOC_ERR;
-        result = wavefrontObjectAddMaterialLibrary(obj, token);
+        result = passOn(target, target->callbacks->onMaterialLibrary(target->context, token));
         free(token);
         if(result) {
             return result;
@@ -97,56 +152,241 @@ static int parseMaterialLibrary(struct WavefrontObject *obj, const char *line) {
     return STATUS_OK;
 }
 
-static int parseUseMaterial(struct WavefrontObject *obj, const char *line) {
-    return wavefrontObjectAddMaterial(obj, line);
+static int parseUseMaterial(struct LineTarget *target, const char *line, const char **position) {
+    return target->callbacks->onMaterial ? passOn(target, target->callbacks->onMaterial(target->context, line)) : STATUS_OK;
+}
+
+static int parseObject(struct LineTarget *target, const char *line, const char **position) {
+    return target->callbacks->onObject ? passOn(target, target->callbacks->onObject(target->context, line)) : STATUS_OK;
 }
 
-static int parseObject(struct WavefrontObject *obj, const char *line) {
-    return wavefrontObjectAddObject(obj, line);
+static int buildVertex(void *context, const struct WavefrontObjectVertex *vertex) {
+    return wavefrontObjectAddVertex((struct WavefrontObject*)context, (struct WavefrontObjectVertex*)vertex);
 }
 
+static int buildUnwrap(void *context, const struct WavefrontObjectUnwrap *unwrap) {
+    return wavefrontObjectAddUnwrap((struct WavefrontObject*)context, (struct WavefrontObjectUnwrap*)unwrap);
+}
+
+static int buildNormal(void *context, const struct WavefrontObjectNormal *normal) {
+    return wavefrontObjectAddNormal((struct WavefrontObject*)context, (struct WavefrontObjectNormal*)normal);
+}
+
+static int buildFace(void *context, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount) {
+    struct WavefrontObject *obj = (struct WavefrontObject*)context;
+    // Build the face in place, reusing the points a reset object kept.
+    struct WavefrontObjectFace *face = wavefrontObjectNextFace(obj);
+    if(face == NULL) return STATUS_ALLOC_ERR;
+    if(wavefrontObjectFaceSetPoints(face, points, pointCount)) return STATUS_ALLOC_ERR;
+    return wavefrontObjectAddFace(obj, face);
+}
+
+static int buildObject(void *context, const char *name) {
+    return wavefrontObjectAddObject((struct WavefrontObject*)context, name);
+}
+
+static int buildMaterial(void *context, const char *name) {
+    return wavefrontObjectAddMaterial((struct WavefrontObject*)context, name);
+}
+
+static int buildMaterialLibrary(void *context, const char *name) {
+    return wavefrontObjectAddMaterialLibrary((struct WavefrontObject*)context, name);
+}
+
+const struct WavefrontObjectCallbacks wavefrontObjectBuilder = {
+    buildVertex,
+    buildUnwrap,
+    buildNormal,
+    buildFace,
+    buildObject,
+    buildMaterial,
+    buildMaterialLibrary
+};
+
 struct Parser {
     char name[8];
-    int (*fn)(void *obj, const char *input);
+    int (*fn)(void *target, const char *input, const char **position);
 };
 struct Parser parsers[] = {
-    {"v", (int (*)(void*, const char*))parseVertex},
-    {"vt", (int (*)(void*, const char*))parseUnwrap},
-    {"vn", (int (*)(void*, const char*))parseNormal},
-    {"f", (int (*)(void*, const char*))parseFace},
-    {"l", (int (*)(void*, const char*))parseFace},
-    {"mtllib", (int (*)(void*, const char*))parseMaterialLibrary},
-    {"usemtl", (int (*)(void*, const char*))parseUseMaterial},
-    {"o", (int (*)(void*, const char*))parseObject},
+    {"v", (int (*)(void*, const char*, const char**))parseVertex},
+    {"vt", (int (*)(void*, const char*, const char**))parseUnwrap},
+    {"vn", (int (*)(void*, const char*, const char**))parseNormal},
+    {"f", (int (*)(void*, const char*, const char**))parseFace},
+    {"l", (int (*)(void*, const char*, const char**))parseFace},
+    {"mtllib", (int (*)(void*, const char*, const char**))parseMaterialLibrary},
+    {"usemtl", (int (*)(void*, const char*, const char**))parseUseMaterial},
+    {"o", (int (*)(void*, const char*, const char**))parseObject},
     {"#", NULL}
 };
 
-int parseWavefrontObjectFromString(struct WavefrontObject *obj, char *input) {
-    wavefrontObjectCompose(obj);
-
-    const char *thisToken = input, *nextDelim = NULL, *nextToken = NULL;
-    while(tokenize(&thisToken, &nextDelim, &nextToken, ASCII_V_DELIMITERS)) {
-        char *line = strCopyN(thisToken, nextDelim-thisToken);
-        if(!line) {
-            wavefrontObjectRelease(obj);
-            return STATUS_ALLOC_ERR;
-        }
-        int result = STATUS_OK;
-        const char *tempLine = strAfterWhitespace(line);
-        const char *thisToken = tempLine, *nextDelim = NULL, *nextToken = NULL;
-        tokenize(&thisToken, &nextDelim, &nextToken, ASCII_H_DELIMITERS);
-        for(int i = 0; i < sizeof(parsers)/sizeof(struct Parser); i++) {
-            if((strStartsWith(thisToken, parsers[i].name) == nextDelim)) {
-                const char *temp = strAfterWhitespace(nextDelim);
-                result = parsers[i].fn ? parsers[i].fn(obj, temp) : STATUS_OK;
-                break;
-            }
-        }
-        free(line);
-        if(result) {
-            wavefrontObjectRelease(obj);
-            return result;
+// Parse one line. On failure position points at the offending token, or at
+// the start of the keyword's arguments when no single token is to blame.
+static int parseLine(struct LineTarget *target, const char *line, const char **position) {
+    const char *tempLine = wavefrontObjectScanPastBlanks(line, target->limit);
+    const char *thisToken = tempLine, *nextDelim = NULL, *nextToken = NULL;
+    tokenize(&thisToken, &nextDelim, &nextToken, ASCII_H_DELIMITERS);
+    for(int i = 0; i < sizeof(parsers)/sizeof(struct Parser); i++) {
+        if((strStartsWith(thisToken, parsers[i].name) == nextDelim)) {
+            const char *temp = wavefrontObjectScanPastBlanks(nextDelim, target->limit);
+            *position = temp;
+            return parsers[i].fn ? parsers[i].fn(target, temp, position) : STATUS_OK;
         }
     }
     return STATUS_OK;
 }
+
+int parseWavefrontObjectLine(struct WavefrontObject *obj, const char *line) {
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    struct LineTarget target = {&parser, &wavefrontObjectBuilder, obj, line + strlen(line) + 1, 0};
+    const char *position;
+    int result = parseLine(&target, line, &position);
+    wavefrontObjectParserRelease(&parser);
+    return result;
+}
+
+int wavefrontObjectParserCompose(struct WavefrontObjectParser *parser) {
+    memset(parser, 0, sizeof(struct WavefrontObjectParser));
+    return STATUS_OK;
+}
+
+void wavefrontObjectParserRelease(struct WavefrontObjectParser *parser) {
+    free(parser->line);
+    free(parser->block);
+    free(parser->points);
+}
+
+void wavefrontObjectParserBegin(struct WavefrontObjectParser *parser) {
+    parser->lineSize = 0;
+    parser->lineNumber = 0;
+    parser->carriageReturn = 0;
+    parser->errorCount = 0;
+}
+
+// Parse the buffered line, reporting and skipping it when it is malformed and
+// the error limit allows. A callback's status is returned as it is.
+static int parseBufferedLine(struct LineTarget *target) {
+    struct WavefrontObjectParser *parser = target->parser;
+    const char *position = parser->line;
+    target->limit = parser->line + parser->lineSize + 1;
+    target->callbackFailed = 0;
+    int result = parseLine(target, parser->line, &position);
+    if(result != STATUS_PARSE_ERR || target->callbackFailed) return result;
+
+    struct WavefrontObjectDiagnostic *diagnostic = &parser->diagnostic;
+    diagnostic->line = parser->lineNumber + 1;
+    diagnostic->column = position - parser->line + 1;
+    const char *keyword = strAfterWhitespace(parser->line);
+    unsigned int length = 0;
+    while(length < sizeof(diagnostic->keyword) - 1 && keyword[length]
+            && !strchr(ASCII_H_DELIMITERS, keyword[length])) {
+        diagnostic->keyword[length] = keyword[length];
+        length++;
+    }
+    diagnostic->keyword[length] = '\0';
+    if(parser->diagnose) parser->diagnose(parser->diagnoseContext, diagnostic);
+    return ++parser->errorCount > parser->errorLimit ? STATUS_PARSE_ERR : STATUS_OK;
+}
+
+static int lineAppend(struct WavefrontObjectParser *parser, const char *data, unsigned long size) {
+    if(parser->lineSize + size + 1 > parser->lineCapacity) {
+        unsigned long capacity = parser->lineCapacity ? parser->lineCapacity : 256;
+        while(parser->lineSize + size + 1 > capacity) capacity *= 2;
+        char *temp = (char*)realloc(parser->line, capacity);
+        if(temp == NULL) return STATUS_ALLOC_ERR;
+        parser->line = temp;
+        parser->lineCapacity = capacity;
+    }
+    memcpy(parser->line + parser->lineSize, data, size);
+    parser->lineSize += size;
+    parser->line[parser->lineSize] = '\0';
+    return STATUS_OK;
+}
+
+int wavefrontObjectParserParseBlockCallbacks(
+        struct WavefrontObjectParser *parser,
+        const struct WavefrontObjectCallbacks *callbacks,
+        void *context,
+        const char *block,
+        unsigned long size) {
+    struct LineTarget target = {parser, callbacks, context, NULL, 0};
+    const char *start = block, *end = block + size, *delimiter;
+    while((delimiter = wavefrontObjectScanLine(start, end)) != end) {
+        int result = lineAppend(parser, start, delimiter - start);
+        if(result == STATUS_OK) result = parseBufferedLine(&target);
+        parser->lineSize = 0;
+        // CR, LF and CRLF each end one line, the LF of a CRLF is not counted.
+        int lineFeedOfCrlf = *delimiter == '\n' && parser->carriageReturn && delimiter == start;
+        if((*delimiter == '\n' && !lineFeedOfCrlf) || *delimiter == '\r') parser->lineNumber++;
+        parser->carriageReturn = *delimiter == '\r';
+        if(result) return result;
+        start = delimiter + 1;
+    }
+    if(start < end) parser->carriageReturn = 0;
+    // Carry the trailing partial line over to the next block.
+    return lineAppend(parser, start, end - start);
+}
+
+int wavefrontObjectParserFinishCallbacks(
+        struct WavefrontObjectParser *parser,
+        const struct WavefrontObjectCallbacks *callbacks,
+        void *context) {
+    if(parser->lineSize == 0) return STATUS_OK;
+    struct LineTarget target = {parser, callbacks, context, NULL, 0};
+    int result = parseBufferedLine(&target);
+    parser->lineSize = 0;
+    return result;
+}
+
+int wavefrontObjectParserParseBlock(
+        struct WavefrontObjectParser *parser,
+        struct WavefrontObject *obj,
+        const char *block,
+        unsigned long size) {
+    return wavefrontObjectParserParseBlockCallbacks(parser, &wavefrontObjectBuilder, obj, block, size);
+}
+
+int wavefrontObjectParserFinish(struct WavefrontObjectParser *parser, struct WavefrontObject *obj) {
+    return wavefrontObjectParserFinishCallbacks(parser, &wavefrontObjectBuilder, obj);
+}
+
+int wavefrontObjectParserParseStringCallbacks(
+        struct WavefrontObjectParser *parser,
+        const struct WavefrontObjectCallbacks *callbacks,
+        void *context,
+        const char *input) {
+    wavefrontObjectParserBegin(parser);
+    int result = wavefrontObjectParserParseBlockCallbacks(parser, callbacks, context, input, strlen(input));
+    if(result == STATUS_OK) result = wavefrontObjectParserFinishCallbacks(parser, callbacks, context);
+    return result;
+}
+
+int wavefrontObjectParserParseString(
+        struct WavefrontObjectParser *parser,
+        struct WavefrontObject *obj,
+        const char *input) {
+    wavefrontObjectCompose(obj);
+    int result = wavefrontObjectParserParseStringCallbacks(parser, &wavefrontObjectBuilder, obj, input);
+    if(result) wavefrontObjectRelease(obj);
+    return result;
+}
+
+// obj must already be composed. It is reset rather than released, on error
+// too, so a service parsing similar models stops allocating once warmed up.
+int wavefrontObjectParserParseStringInto(
+        struct WavefrontObjectParser *parser,
+        struct WavefrontObject *obj,
+        const char *input) {
+    wavefrontObjectReset(obj);
+    int result = wavefrontObjectParserParseStringCallbacks(parser, &wavefrontObjectBuilder, obj, input);
+    if(result) wavefrontObjectReset(obj);
+    return result;
+}
+
+int parseWavefrontObjectFromString(struct WavefrontObject *obj, char *input) {
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    int result = wavefrontObjectParserParseString(&parser, obj, input);
+    wavefrontObjectParserRelease(&parser);
+    return result;
+}
@@ -6,6 +6,70 @@ extern "C"{
 
 #include "wavefront_object.h"
 
+// Called for each element as it is parsed, a non-zero STATUS_* return stops
+// the parse with that status. Points and strings are only valid during the
+// call. Callbacks left NULL skip their elements.
+struct WavefrontObjectCallbacks {
+    int (*onVertex)(void *context, const struct WavefrontObjectVertex *vertex);
+    int (*onUnwrap)(void *context, const struct WavefrontObjectUnwrap *unwrap);
+    int (*onNormal)(void *context, const struct WavefrontObjectNormal *normal);
+    int (*onFace)(void *context, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount);
+    int (*onObject)(void *context, const char *name);
+    int (*onMaterial)(void *context, const char *name);
+    int (*onMaterialLibrary)(void *context, const char *name);
+};
+
+// Builds the struct WavefrontObject passed as context.
+extern const struct WavefrontObjectCallbacks wavefrontObjectBuilder;
+
+// Where a line failed to parse. line and column count from one and keyword
+// is the line's first token, cut to fit.
+struct WavefrontObjectDiagnostic {
+    unsigned long line;
+    unsigned long column;
+    char keyword[8];
+};
+
+typedef void (*WavefrontObjectDiagnosticSink)(void *context, const struct WavefrontObjectDiagnostic *diagnostic);
+
+// Scratch memory kept between parses, give every thread its own parser.
+// line holds the partial line carried between blocks, block is the read
+// buffer used for file input and points collects the points of a face.
+// Lines that fail to parse are passed to diagnose and skipped until more than
+// errorLimit have failed, the default of zero stops at the first. Bad lines
+// are only ever skipped whole, never repaired, so a face with one bad point is
+// dropped rather than cut short and the object holds nothing the file did not
+// spell out. diagnostic holds the last failure and errorCount the failures of
+// the current parse.
+// Lines end at LF, CR or CRLF for lineNumber, carriageReturn notes a CR that
+// ended the last block so an LF opening the next is not counted again.
+struct WavefrontObjectParser {
+    char *line;
+    char *block;
+    unsigned long lineSize;
+    unsigned long lineCapacity;
+    struct WavefrontObjectPoint *points;
+    WavefrontObjectCount pointCapacity;
+    WavefrontObjectDiagnosticSink diagnose;
+    void *diagnoseContext;
+    unsigned long errorLimit;
+    unsigned long errorCount;
+    unsigned long lineNumber;
+    int carriageReturn;
+    struct WavefrontObjectDiagnostic diagnostic;
+};
+
+int wavefrontObjectParserCompose(struct WavefrontObjectParser *parser);
+void wavefrontObjectParserRelease(struct WavefrontObjectParser *parser);
+void wavefrontObjectParserBegin(struct WavefrontObjectParser *parser);
+int wavefrontObjectParserParseBlockCallbacks(struct WavefrontObjectParser *parser, const struct WavefrontObjectCallbacks *callbacks, void *context, const char *block, unsigned long size);
+int wavefrontObjectParserFinishCallbacks(struct WavefrontObjectParser *parser, const struct WavefrontObjectCallbacks *callbacks, void *context);
+int wavefrontObjectParserParseStringCallbacks(struct WavefrontObjectParser *parser, const struct WavefrontObjectCallbacks *callbacks, void *context, const char *input);
+int wavefrontObjectParserParseBlock(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *block, unsigned long size);
+int wavefrontObjectParserFinish(struct WavefrontObjectParser *parser, struct WavefrontObject *obj);
+int wavefrontObjectParserParseString(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *input);
+int wavefrontObjectParserParseStringInto(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *input);
+int parseWavefrontObjectLine(struct WavefrontObject *obj, const char *line);
 int parseWavefrontObjectFromString(struct WavefrontObject *obj, char *input);
 
 #ifdef __cplusplus
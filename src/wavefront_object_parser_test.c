@@ -1,5 +1,7 @@
+#include <stdlib.h>
 #include "wavefront_object_parser.h"
 #include "cutil/src/error.h"
+#include "cutil/src/string.h"
 #include "cutil/src/assertion.h"
 
 void canParseEmptyString() {
@@ -521,6 +523,372 @@ void normalWavefrontObjectFromString() {
     wavefrontObjectRelease(&wObj);
 }
 
+void parserReuseKeepsBuffers() {
+    const char first[] = "\
+    mtllib scene.mtl\n\
+    o longer_name\n\
+    v 1 2 3\n\
+    v 4 5 6\n\
+    v 7 8 9\n\
+    usemtl red\n\
+    f 1 2 3\n\
+    f 3 2 1\n";
+    const char second[] = "\
+    o short\n\
+    v 9 8 7\n\
+    v 6 5 4\n\
+    v 3 2 1\n\
+    usemtl blue\n\
+    f 2 3 1\n";
+
+    struct WavefrontObjectParser parser;
+    struct WavefrontObject wObj;
+    wavefrontObjectParserCompose(&parser);
+    wavefrontObjectCompose(&wObj);
+    int result = wavefrontObjectParserParseStringInto(&parser, &wObj, first);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.objects->faceCount, 2);
+    struct WavefrontObjectVertex *vertices = wObj.vertices;
+    struct WavefrontObjectFace *faces = wObj.objects->faces;
+    struct WavefrontObjectPoint *points = faces->points;
+    char *name = wObj.objects->name;
+
+    result = wavefrontObjectParserParseStringInto(&parser, &wObj, second);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.materialLibraryCount, 0);
+    assertIntegersEqual(wObj.objectCount, 1);
+    assertStringsEqual(wObj.objects->name, "short");
+    assertIntegersEqual(wObj.vertexCount, 3);
+    assertFloatsEqual(wObj.vertices->x, 9.0);
+    assertIntegersEqual(wObj.materialCount, 1);
+    assertStringsEqual(wObj.materials[0], "blue");
+    assertIntegersEqual(wObj.objects->faceCount, 1);
+    assertIntegersEqual(wObj.objects->faces->points[0].v, 2);
+    assertIntegersEqual(wObj.objects->faces->material, 0);
+    // Everything fit in the buffers of the first parse.
+    assertIntegersEqual(wObj.vertices == vertices, 1);
+    assertIntegersEqual(wObj.objects->faces == faces, 1);
+    assertIntegersEqual(wObj.objects->faces->points == points, 1);
+    assertIntegersEqual(wObj.objects->name == name, 1);
+
+    // A failed parse leaves an empty object that can still be reused.
+    result = wavefrontObjectParserParseStringInto(&parser, &wObj, "v 1 2\n");
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(wObj.vertexCount, 0);
+    result = wavefrontObjectParserParseStringInto(&parser, &wObj, first);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.objects->faceCount, 2);
+    assertIntegersEqual(wObj.objects->faces[1].points[0].v, 3);
+    wavefrontObjectRelease(&wObj);
+    wavefrontObjectParserRelease(&parser);
+}
+
+// Built the way callers did before objects had capacities, by setting counts.
+void resetKeepsHandBuiltBuffers() {
+    struct WavefrontObject wObj;
+    wavefrontObjectCompose(&wObj);
+    wObj.objectCount = 3;
+    wObj.objects = (struct WavefrontObjectObject*)malloc(3 * sizeof(struct WavefrontObjectObject));
+    for(int i = 0; i < 3; i++) {
+        struct WavefrontObjectObject *o = wObj.objects + i;
+        o->name = strCopy("hand");
+        o->faceCount = 2;
+        o->faceCapacity = 0;
+        o->faces = (struct WavefrontObjectFace*)malloc(2 * sizeof(struct WavefrontObjectFace));
+        for(int j = 0; j < 2; j++) {
+            o->faces[j].points = (struct WavefrontObjectPoint*)calloc(1, sizeof(struct WavefrontObjectPoint));
+            o->faces[j].pointCount = 1;
+            o->faces[j].pointCapacity = 1000;
+        }
+    }
+    wObj.materialCount = 1;
+    wObj.materials = (char**)malloc(sizeof(char*));
+    wObj.materials[0] = strCopy("red");
+
+    // Reparsing grows past the first reallocation, the leak checker sees the rest.
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    int result = wavefrontObjectParserParseStringInto(&parser, &wObj,
+        "v 0 0 0\no a\nf 1 1 1 1 1\no b\no c\no d\no e\nusemtl x\nusemtl y\n");
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.objectCount, 5);
+    assertIntegersEqual(wObj.objects->faces->pointCount, 5);
+    assertIntegersEqual(wObj.objectCapacity >= 5, 1);
+    wavefrontObjectRelease(&wObj);
+    wavefrontObjectParserRelease(&parser);
+}
+
+struct DiagnosticLog {
+    struct WavefrontObjectDiagnostic diagnostics[4];
+    unsigned int count;
+};
+
+static void logDiagnostic(void *context, const struct WavefrontObjectDiagnostic *diagnostic) {
+    struct DiagnosticLog *log = (struct DiagnosticLog*)context;
+    if(log->count < 4) log->diagnostics[log->count] = *diagnostic;
+    log->count++;
+}
+
+void parserLenientSkipsBadLines() {
+    const char input[] = "v 1 2 3\r\n\
+v 4 5 6\r\n\
+v 7 8\r\n\
+f 1 2 x\r\n\
+  f 1 2 3\r\n\
+vn 0 0";
+
+    struct DiagnosticLog log;
+    log.count = 0;
+    struct WavefrontObjectParser parser;
+    struct WavefrontObject wObj;
+    wavefrontObjectParserCompose(&parser);
+    parser.diagnose = logDiagnostic;
+    parser.diagnoseContext = &log;
+    parser.errorLimit = 5;
+    int result = wavefrontObjectParserParseString(&parser, &wObj, input);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(parser.errorCount, 3);
+    assertIntegersEqual(wObj.vertexCount, 2);
+    assertIntegersEqual(wObj.normalCount, 0);
+    assertIntegersEqual(wObj.objectCount, 1);
+    assertIntegersEqual(wObj.objects->faceCount, 1);
+    assertIntegersEqual(wObj.objects->faces->points[2].v, 3);
+
+    assertIntegersEqual(log.count, 3);
+    assertIntegersEqual(log.diagnostics[0].line, 3);
+    assertIntegersEqual(log.diagnostics[0].column, 3);
+    assertStringsEqual(log.diagnostics[0].keyword, "v");
+    assertIntegersEqual(log.diagnostics[1].line, 4);
+    assertIntegersEqual(log.diagnostics[1].column, 7);
+    assertStringsEqual(log.diagnostics[1].keyword, "f");
+    assertIntegersEqual(log.diagnostics[2].line, 6);
+    assertStringsEqual(log.diagnostics[2].keyword, "vn");
+    wavefrontObjectRelease(&wObj);
+
+    // One error over the limit fails the parse.
+    parser.errorLimit = 2;
+    result = wavefrontObjectParserParseString(&parser, &wObj, input);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(parser.diagnostic.line, 6);
+    wavefrontObjectParserRelease(&parser);
+}
+
+static int rejectFace(void *context, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount) {
+    (*(unsigned int*)context)++;
+    return STATUS_PARSE_ERR;
+}
+
+void parserLenientPassesCallbackErrors() {
+    struct WavefrontObjectCallbacks callbacks = {NULL, NULL, NULL, rejectFace, NULL, NULL, NULL};
+    struct DiagnosticLog log;
+    log.count = 0;
+    unsigned int faces = 0;
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    parser.diagnose = logDiagnostic;
+    parser.diagnoseContext = &log;
+    parser.errorLimit = 5;
+    int result = wavefrontObjectParserParseStringCallbacks(&parser, &callbacks, &faces, "v 1 2\nf 1 1 1\nf 1 1 1\n");
+    // The callback stops the parse and is not reported as a bad line.
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(faces, 1);
+    assertIntegersEqual(parser.errorCount, 1);
+    assertIntegersEqual(log.count, 1);
+    assertIntegersEqual(log.diagnostics[0].line, 1);
+    wavefrontObjectParserRelease(&parser);
+}
+
+void parserCountsCarriageReturnLines() {
+    const char *inputs[] = {
+        "v 1 2 3\rv 4 5 6\rv 7 8\rf 1 2 3\r",
+        "v 1 2 3\r\nv 4 5 6\r\nv 7 8\r\nf 1 2 3\r\n",
+        "v 1 2 3\nv 4 5 6\rv 7 8\r\nf 1 2 3\n"};
+    struct WavefrontObjectParser parser;
+    struct WavefrontObject wObj;
+    wavefrontObjectParserCompose(&parser);
+    for(int i = 0; i < 3; i++) {
+        int result = wavefrontObjectParserParseString(&parser, &wObj, inputs[i]);
+        assertIntegersEqual(result, STATUS_PARSE_ERR);
+        assertIntegersEqual(parser.diagnostic.line, 3);
+    }
+    // A CRLF split between blocks still ends one line.
+    const char *input = inputs[1];
+    wavefrontObjectCompose(&wObj);
+    wavefrontObjectParserBegin(&parser);
+    assertIntegersEqual(wavefrontObjectParserParseBlock(&parser, &wObj, input, 8), STATUS_OK);
+    assertIntegersEqual(wavefrontObjectParserParseBlock(&parser, &wObj, input + 8, 9), STATUS_OK);
+    assertIntegersEqual(wavefrontObjectParserParseBlock(&parser, &wObj, input + 17, strlen(input) - 17), STATUS_PARSE_ERR);
+    assertIntegersEqual(parser.diagnostic.line, 3);
+    wavefrontObjectRelease(&wObj);
+    wavefrontObjectParserRelease(&parser);
+}
+
+void parserStrictReportsFirstError() {
+    const char input[] = "o test\nf 1 2\nf 1 2/a 3\nv 1 2 3\n";
+    struct WavefrontObjectParser parser;
+    struct WavefrontObject wObj;
+    wavefrontObjectParserCompose(&parser);
+    int result = wavefrontObjectParserParseString(&parser, &wObj, input);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(parser.errorCount, 1);
+    assertIntegersEqual(parser.diagnostic.line, 3);
+    assertIntegersEqual(parser.diagnostic.column, 5);
+    assertStringsEqual(parser.diagnostic.keyword, "f");
+    wavefrontObjectParserRelease(&parser);
+}
+
+void parseFaceIndexRange() {
+    struct WavefrontObject wObj;
+    wavefrontObjectCompose(&wObj);
+    int result = parseWavefrontObjectLine(&wObj, "f 1 2 99999999999999999999");
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    result = parseWavefrontObjectLine(&wObj, "f 1 2 3000000000");
+#ifdef COBJ_LARGE
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.objects->faces->points[2].v == 3000000000LL, 1);
+    assertIntegersEqual(wavefrontObjectFitsCompact(&wObj), 0);
+#else
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(wavefrontObjectFitsCompact(&wObj), 1);
+#endif
+    wavefrontObjectRelease(&wObj);
+}
+
+void addFailsPastCountLimit() {
+    struct WavefrontObjectFace face = {NULL, WAVEFRONT_OBJECT_COUNT_MAX, 0};
+    struct WavefrontObjectPoint point = {1, 0, 0};
+    assertIntegersEqual(wavefrontObjectFaceAddPoint(&face, &point), STATUS_ALLOC_ERR);
+    assertIntegersEqual(face.points == NULL, 1);
+}
+
+void faceAddPointIgnoresCapacity() {
+    // Set up the way callers did before pointCapacity existed.
+    struct WavefrontObjectFace face;
+    face.pointCapacity = 1000;
+    face.points = NULL;
+    face.pointCount = 0;
+    for(int i = 1; i <= 5; i++) {
+        struct WavefrontObjectPoint point = {i, 0, 0};
+        assertIntegersEqual(wavefrontObjectFaceAddPoint(&face, &point), STATUS_OK);
+    }
+    assertIntegersEqual(face.pointCount, 5);
+    assertIntegersEqual(face.points[4].v, 5);
+
+    // Added to an object, the slot only trusts the points it was given.
+    struct WavefrontObject wObj;
+    wavefrontObjectCompose(&wObj);
+    assertIntegersEqual(wavefrontObjectAddFace(&wObj, &face), STATUS_OK);
+    wavefrontObjectReset(&wObj);
+    struct WavefrontObjectPoint points[8] = {{1, 0, 0}};
+    struct WavefrontObjectFace *slot = wavefrontObjectNextFace(&wObj);
+    assertIntegersEqual(wavefrontObjectFaceSetPoints(slot, points, 8), STATUS_OK);
+    assertIntegersEqual(slot->pointCapacity, 8);
+    wavefrontObjectRelease(&wObj);
+}
+
+struct CallbackMesh {
+    float positions[12];
+    int indices[8];
+    unsigned int vertexCount, indexCount, normalCount, objectCount;
+    char material[16];
+};
+
+static int meshVertex(void *context, const struct WavefrontObjectVertex *vertex) {
+    struct CallbackMesh *mesh = (struct CallbackMesh*)context;
+    if(mesh->vertexCount == 4) return STATUS_ALLOC_ERR;
+    float *position = mesh->positions + 3 * mesh->vertexCount++;
+    position[0] = vertex->x;
+    position[1] = vertex->y;
+    position[2] = vertex->z;
+    return STATUS_OK;
+}
+
+static int meshNormal(void *context, const struct WavefrontObjectNormal *normal) {
+    ((struct CallbackMesh*)context)->normalCount++;
+    return STATUS_OK;
+}
+
+static int meshFace(void *context, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount) {
+    struct CallbackMesh *mesh = (struct CallbackMesh*)context;
+    for(WavefrontObjectCount i = 0; i < pointCount && mesh->indexCount < 8; i++) {
+        mesh->indices[mesh->indexCount++] = points[i].v - 1;
+    }
+    return STATUS_OK;
+}
+
+static int meshObject(void *context, const char *name) {
+    ((struct CallbackMesh*)context)->objectCount++;
+    return STATUS_OK;
+}
+
+static int meshMaterial(void *context, const char *name) {
+    strncpy(((struct CallbackMesh*)context)->material, name, 15);
+    return STATUS_OK;
+}
+
+void parserCallbacksReceiveElements() {
+    const char input[] = "\
+    o quad\n\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 1 1 0\n\
+    vt 0.5 0.5\n\
+    vn 0 0 1\n\
+    usemtl stone\n\
+    f 1/1/1 2/1/1 3/1/1\n\
+    f 3 2 1";
+    struct CallbackMesh mesh;
+    memset(&mesh, 0, sizeof(struct CallbackMesh));
+    struct WavefrontObjectCallbacks callbacks = {
+        meshVertex, NULL, meshNormal, meshFace, meshObject, meshMaterial, NULL};
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    int result = wavefrontObjectParserParseStringCallbacks(&parser, &callbacks, &mesh, input);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(mesh.vertexCount, 3);
+    assertFloatsEqual(mesh.positions[6], 1.0);
+    assertIntegersEqual(mesh.normalCount, 1);
+    assertIntegersEqual(mesh.objectCount, 1);
+    assertStringsEqual(mesh.material, "stone");
+    assertIntegersEqual(mesh.indexCount, 6);
+    assertIntegersEqual(mesh.indices[2], 2);
+    assertIntegersEqual(mesh.indices[3], 2);
+
+    // A callback's status stops the parse.
+    const char tooMany[] = "v 0 0 0\nv 0 0 0\nv 0 0 0\nv 0 0 0\nv 0 0 0\n";
+    memset(&mesh, 0, sizeof(struct CallbackMesh));
+    result = wavefrontObjectParserParseStringCallbacks(&parser, &callbacks, &mesh, tooMany);
+    assertIntegersEqual(result, STATUS_ALLOC_ERR);
+    assertIntegersEqual(mesh.vertexCount, 4);
+    wavefrontObjectParserRelease(&parser);
+}
+
+void objectsEqualComparesFields() {
+    char input[] = "\
+    o quad\n\
+    v 0 0 0\n\
+    v nan 1 0\n\
+    usemtl red\n\
+    f 1 2 2 1\n";
+    char moved[] = "\
+    o quad\n\
+    v 0 0 0\n\
+    v nan 1 0\n\
+    usemtl red\n\
+    f 1 2 1 2\n";
+    struct WavefrontObject a, b, c;
+    parseWavefrontObjectFromString(&a, input);
+    parseWavefrontObjectFromString(&b, input);
+    parseWavefrontObjectFromString(&c, moved);
+    assertIntegersEqual(wavefrontObjectEqual(&a, &b), 1);
+    assertIntegersEqual(wavefrontObjectEqual(&a, &c), 0);
+    b.currentMaterial = -1;
+    assertIntegersEqual(wavefrontObjectEqual(&a, &b), 0);
+    wavefrontObjectRelease(&a);
+    wavefrontObjectRelease(&b);
+    wavefrontObjectRelease(&c);
+}
+
 void wavefrontObjectParserTest() {
     canParseEmptyString();
     canParseLine();
@@ -573,4 +941,15 @@ void wavefrontObjectParserTest() {
     parseUseMaterialTest();
 
     normalWavefrontObjectFromString();
+    parserReuseKeepsBuffers();
+    resetKeepsHandBuiltBuffers();
+    parserLenientSkipsBadLines();
+    parserLenientPassesCallbackErrors();
+    parserCountsCarriageReturnLines();
+    parserStrictReportsFirstError();
+    parseFaceIndexRange();
+    addFailsPastCountLimit();
+    faceAddPointIgnoresCapacity();
+    parserCallbacksReceiveElements();
+    objectsEqualComparesFields();
 }
@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <math.h>
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_quantize.h"
+
+#define QUANTIZE_UNORM_MAX 65535.0
+#define QUANTIZE_SNORM_MAX 32767.0
+
+unsigned short wavefrontObjectHalfFromDouble(double value) {
+    float single = (float)value;
+    unsigned int bits;
+    memcpy(&bits, &single, sizeof(bits));
+    unsigned int sign = (bits >> 16) & 0x8000;
+    unsigned int mantissa = bits & 0x7fffff;
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    if(((bits >> 23) & 0xff) == 0xff) return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    if(exponent >= 31) return sign | 0x7c00;
+    unsigned int half, remainder, halfway;
+    if(exponent <= 0) {
+        // Subnormal half, shift the implicit bit into the mantissa.
+        if(exponent < -10) return sign;
+        mantissa |= 0x800000;
+        unsigned int shift = 14 - exponent;
+        half = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    } else {
+        half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+        remainder = mantissa & 0x1fff;
+        halfway = 0x1000;
+    }
+    // Round half to even, a carry out of the mantissa correctly bumps the exponent.
+    if(remainder > halfway || (remainder == halfway && (half & 1))) half++;
+    return sign | half;
+}
+
+double wavefrontObjectHalfToDouble(unsigned short half) {
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+    double value;
+    if(exponent == 0) value = ldexp(mantissa, -24);
+    else if(exponent == 31) value = mantissa ? NAN : HUGE_VAL;
+    else value = ldexp(mantissa + 1024, exponent - 25);
+    return (half & 0x8000) ? -value : value;
+}
+
+static double signNotZero(double value) {
+    return value < 0 ? -1.0 : 1.0;
+}
+
+static void octahedralDecode(const short encoded[2], double normal[3]) {
+    double x = encoded[0] / QUANTIZE_SNORM_MAX, y = encoded[1] / QUANTIZE_SNORM_MAX;
+    if(x < -1) x = -1;
+    if(y < -1) y = -1;
+    double z = 1.0 - fabs(x) - fabs(y);
+    if(z < 0) {
+        double folded = (1.0 - fabs(y)) * signNotZero(x);
+        y = (1.0 - fabs(x)) * signNotZero(y);
+        x = folded;
+    }
+    double length = sqrt(x*x + y*y + z*z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
+
+static double angleBetween(const double a[3], const double b[3]) {
+    double cosine = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    if(cosine > 1) cosine = 1;
+    if(cosine < -1) cosine = -1;
+    return acos(cosine);
+}
+
+// Octahedral encoding, keeping whichever neighbouring lattice point decodes closest to the input.
+static double octahedralEncode(const struct WavefrontObjectNormal *input, short encoded[2]) {
+    double length = sqrt(input->x*input->x + input->y*input->y + input->z*input->z);
+    if(!(length > 0) || !isfinite(length)) {
+        encoded[0] = encoded[1] = 0;
+        return 0;
+    }
+    double n[3] = {input->x / length, input->y / length, input->z / length};
+    double l1 = fabs(n[0]) + fabs(n[1]) + fabs(n[2]);
+    double u = n[0] / l1, v = n[1] / l1;
+    if(n[2] < 0) {
+        double folded = (1.0 - fabs(v)) * signNotZero(u);
+        v = (1.0 - fabs(u)) * signNotZero(v);
+        u = folded;
+    }
+    double bestError = HUGE_VAL;
+    for(int i = 0; i < 4; i++) {
+        double su = (i & 1 ? ceil(u * QUANTIZE_SNORM_MAX) : floor(u * QUANTIZE_SNORM_MAX));
+        double sv = (i & 2 ? ceil(v * QUANTIZE_SNORM_MAX) : floor(v * QUANTIZE_SNORM_MAX));
+        short candidate[2] = {(short)su, (short)sv};
+        double decoded[3];
+        octahedralDecode(candidate, decoded);
+        double error = angleBetween(n, decoded);
+        if(error < bestError) {
+            bestError = error;
+            encoded[0] = candidate[0];
+            encoded[1] = candidate[1];
+        }
+    }
+    return bestError;
+}
+
+int wavefrontObjectQuantize(struct WavefrontObjectQuantized *quantized, const struct WavefrontObject *obj) {
+    memset(quantized, 0, sizeof(struct WavefrontObjectQuantized));
+    if(!wavefrontObjectFitsCompact(obj)) return STATUS_ALLOC_ERR;
+    quantized->positions = (unsigned short*)malloc(3 * obj->vertexCount * sizeof(unsigned short) + 1);
+    quantized->normals = (short*)malloc(2 * obj->normalCount * sizeof(short) + 1);
+    quantized->unwraps = (unsigned short*)malloc(2 * obj->unwrapCount * sizeof(unsigned short) + 1);
+    if(!quantized->positions || !quantized->normals || !quantized->unwraps) {
+        wavefrontObjectQuantizedRelease(quantized);
+        return STATUS_ALLOC_ERR;
+    }
+    quantized->vertexCount = obj->vertexCount;
+    quantized->normalCount = obj->normalCount;
+    quantized->unwrapCount = obj->unwrapCount;
+
+    double min[3] = {INFINITY, INFINITY, INFINITY}, max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for(unsigned int i = 0; i < obj->vertexCount; i++) {
+        const struct WavefrontObjectVertex *vertex = obj->vertices + i;
+        double p[3] = {vertex->x, vertex->y, vertex->z};
+        for(int c = 0; c < 3; c++) {
+            if(!isfinite(p[c])) continue;
+            if(p[c] < min[c]) min[c] = p[c];
+            if(p[c] > max[c]) max[c] = p[c];
+        }
+    }
+    for(int c = 0; c < 3; c++) {
+        if(min[c] > max[c]) min[c] = max[c] = 0;
+        quantized->offset[c] = min[c];
+        quantized->scale[c] = (max[c] - min[c]) / QUANTIZE_UNORM_MAX;
+        // An extent past the largest double still has a finite step.
+        if(!isfinite(quantized->scale[c])) quantized->scale[c] = max[c] / QUANTIZE_UNORM_MAX - min[c] / QUANTIZE_UNORM_MAX;
+    }
+
+    for(unsigned int i = 0; i < obj->vertexCount; i++) {
+        const struct WavefrontObjectVertex *vertex = obj->vertices + i;
+        double p[3] = {vertex->x, vertex->y, vertex->z}, decoded[3], error = 0;
+        int finite = 1;
+        for(int c = 0; c < 3; c++) {
+            double value = 0;
+            if(quantized->scale[c] > 0) value = floor((p[c] - min[c]) / quantized->scale[c] + 0.5);
+            // A NaN fails both tests and lands on 0, the cast is only defined in range.
+            if(!(value > 0)) value = 0;
+            if(value > QUANTIZE_UNORM_MAX) value = QUANTIZE_UNORM_MAX;
+            quantized->positions[3*i + c] = (unsigned short)value;
+            finite &= isfinite(p[c]) != 0;
+        }
+        if(!finite) continue;
+        wavefrontObjectQuantizedPosition(quantized, i, decoded);
+        for(int c = 0; c < 3; c++) error += (decoded[c] - p[c]) * (decoded[c] - p[c]);
+        error = sqrt(error);
+        if(error > quantized->positionError) quantized->positionError = error;
+    }
+
+    for(unsigned int i = 0; i < obj->normalCount; i++) {
+        double error = octahedralEncode(obj->normals + i, quantized->normals + 2*i);
+        if(error > quantized->normalError) quantized->normalError = error;
+    }
+
+    for(unsigned int i = 0; i < obj->unwrapCount; i++) {
+        const struct WavefrontObjectUnwrap *unwrap = obj->unwraps + i;
+        double decoded[2];
+        quantized->unwraps[2*i] = wavefrontObjectHalfFromDouble(unwrap->u);
+        quantized->unwraps[2*i + 1] = wavefrontObjectHalfFromDouble(unwrap->v);
+        wavefrontObjectQuantizedUnwrap(quantized, i, decoded);
+        double error = fabs(decoded[0] - unwrap->u);
+        if(fabs(decoded[1] - unwrap->v) > error) error = fabs(decoded[1] - unwrap->v);
+        if(error > quantized->unwrapError) quantized->unwrapError = error;
+    }
+    return STATUS_OK;
+}
+
+void wavefrontObjectQuantizedRelease(struct WavefrontObjectQuantized *quantized) {
+    free(quantized->positions);
+    free(quantized->normals);
+    free(quantized->unwraps);
+}
+
+void wavefrontObjectQuantizedPosition(
+        const struct WavefrontObjectQuantized *quantized,
+        unsigned int index,
+        double position[3]) {
+    for(int c = 0; c < 3; c++) {
+        position[c] = quantized->offset[c] + quantized->positions[3*index + c] * quantized->scale[c];
+    }
+}
+
+void wavefrontObjectQuantizedNormal(
+        const struct WavefrontObjectQuantized *quantized,
+        unsigned int index,
+        double normal[3]) {
+    octahedralDecode(quantized->normals + 2*index, normal);
+}
+
+void wavefrontObjectQuantizedUnwrap(
+        const struct WavefrontObjectQuantized *quantized,
+        unsigned int index,
+        double unwrap[2]) {
+    unwrap[0] = wavefrontObjectHalfToDouble(quantized->unwraps[2*index]);
+    unwrap[1] = wavefrontObjectHalfToDouble(quantized->unwraps[2*index + 1]);
+}
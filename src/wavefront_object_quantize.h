@@ -0,0 +1,44 @@
+#ifndef __WAVEFRONT_OBJECT_QUANTIZE_H
+#define __WAVEFRONT_OBJECT_QUANTIZE_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+
+// Compact vertex attributes for streaming.
+// positions: three unsigned 16 bit values per vertex, position = offset + value * scale.
+// The bounds span every vertex rather than each object, as an OBJ vertex belongs to no
+// object and any face may use it. Split with wavefrontObjectSplitByObject first for
+// bounds per object. Non-finite coordinates are clamped into the bounds of the finite
+// ones and left out of positionError, non-finite normals are encoded as zero normals.
+// normals: two signed 16 bit octahedral coordinates per normal.
+// unwraps: u and v of every unwrap as IEEE 754 half floats.
+// The largest error of each attribute is measured by decoding every quantized value,
+// as a distance for positions, an angle in radians for normals and per component for unwraps.
+struct WavefrontObjectQuantized {
+    unsigned short *positions;
+    short *normals;
+    unsigned short *unwraps;
+    unsigned int vertexCount;
+    unsigned int normalCount;
+    unsigned int unwrapCount;
+    double offset[3];
+    double scale[3];
+    double positionError;
+    double normalError;
+    double unwrapError;
+};
+
+int wavefrontObjectQuantize(struct WavefrontObjectQuantized *quantized, const struct WavefrontObject *obj);
+void wavefrontObjectQuantizedRelease(struct WavefrontObjectQuantized *quantized);
+void wavefrontObjectQuantizedPosition(const struct WavefrontObjectQuantized *quantized, unsigned int index, double position[3]);
+void wavefrontObjectQuantizedNormal(const struct WavefrontObjectQuantized *quantized, unsigned int index, double normal[3]);
+void wavefrontObjectQuantizedUnwrap(const struct WavefrontObjectQuantized *quantized, unsigned int index, double unwrap[2]);
+unsigned short wavefrontObjectHalfFromDouble(double value);
+double wavefrontObjectHalfToDouble(unsigned short half);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,114 @@
+#include <math.h>
+#include "wavefront_object_quantize.h"
+#include "wavefront_object_parser.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+void halfConversionRoundTrips() {
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(0.0), 0x0000);
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(1.0), 0x3c00);
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(-2.0), 0xc000);
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(0.5), 0x3800);
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(65504.0), 0x7bff);
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(1e6), 0x7c00);
+    // Smallest subnormal half.
+    assertIntegersEqual(wavefrontObjectHalfFromDouble(ldexp(1, -24)), 0x0001);
+    assertFloatsEqual(wavefrontObjectHalfToDouble(0x3c00), 1.0);
+    assertFloatsEqual(wavefrontObjectHalfToDouble(0xc000), -2.0);
+    assertFloatsEqual(wavefrontObjectHalfToDouble(0x7bff), 65504.0);
+    assertIntegersEqual(wavefrontObjectHalfToDouble(0x0001) == ldexp(1, -24), 1);
+}
+
+void quantizeEmptyObject() {
+    char input[] = "";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectQuantized quantized;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectQuantize(&quantized, &wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(quantized.vertexCount, 0);
+    assertFloatsEqual(quantized.positionError, 0);
+    wavefrontObjectQuantizedRelease(&quantized);
+    wavefrontObjectRelease(&wObj);
+}
+
+void quantizeReportsMaximumError() {
+    char input[] = "\
+    v -1.0 2.0 5.0\n\
+    v 3.0 2.0 5.5\n\
+    v 0.123456 2.0 5.25\n\
+    vt 0.5 0.25\n\
+    vt 0.1 0.9\n\
+    vn 0 0 1\n\
+    vn 0.3 -0.4 -0.5\n\
+    vn 0 0 0\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectQuantized quantized;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectQuantize(&quantized, &wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(quantized.vertexCount, 3);
+    assertIntegersEqual(quantized.normalCount, 3);
+    assertIntegersEqual(quantized.unwrapCount, 2);
+
+    double position[3];
+    wavefrontObjectQuantizedPosition(&quantized, 0, position);
+    assertFloatsEqual(position[0], -1.0);
+    assertFloatsEqual(position[1], 2.0);
+    assertFloatsEqual(position[2], 5.0);
+    wavefrontObjectQuantizedPosition(&quantized, 1, position);
+    assertFloatsEqual(position[0], 3.0);
+    assertFloatsEqual(position[2], 5.5);
+    // Half a quantization step on x and z at worst.
+    assertIntegersEqual(quantized.positionError > 0, 1);
+    assertIntegersEqual(quantized.positionError <= sqrt(pow(2.0 / 65535, 2) + pow(0.25 / 65535, 2)), 1);
+
+    double normal[3];
+    wavefrontObjectQuantizedNormal(&quantized, 0, normal);
+    assertFloatsEqual(normal[2], 1.0);
+    wavefrontObjectQuantizedNormal(&quantized, 1, normal);
+    assertIntegersEqual(normal[2] < 0, 1);
+    assertIntegersEqual(quantized.normalError < 1e-4, 1);
+
+    double unwrap[2];
+    wavefrontObjectQuantizedUnwrap(&quantized, 0, unwrap);
+    assertFloatsEqual(unwrap[0], 0.5);
+    assertFloatsEqual(unwrap[1], 0.25);
+    assertIntegersEqual(quantized.unwrapError > 0, 1);
+    assertIntegersEqual(quantized.unwrapError < 5e-4, 1);
+    wavefrontObjectQuantizedRelease(&quantized);
+    wavefrontObjectRelease(&wObj);
+}
+
+void quantizeClampsNonFiniteValues() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 2 4 8\n\
+    v nan inf -inf\n\
+    vn nan 0 1\n\
+    vn inf 0 0\n";
+    struct WavefrontObject wObj;
+    struct WavefrontObjectQuantized quantized;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectQuantize(&quantized, &wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    // Bounds come from the finite vertices alone.
+    assertFloatsEqual(quantized.offset[0], 0);
+    assertFloatsEqual(quantized.scale[2], 8.0 / 65535);
+    assertIntegersEqual(quantized.positions[6], 0);
+    assertIntegersEqual(quantized.positions[7], 65535);
+    assertIntegersEqual(quantized.positions[8], 0);
+    assertFloatsEqual(quantized.positionError, 0);
+    assertIntegersEqual(quantized.normals[0], 0);
+    assertIntegersEqual(quantized.normals[3], 0);
+    assertFloatsEqual(quantized.normalError, 0);
+    wavefrontObjectQuantizedRelease(&quantized);
+    wavefrontObjectRelease(&wObj);
+}
+
+void wavefrontObjectQuantizeTest() {
+    halfConversionRoundTrips();
+    quantizeEmptyObject();
+    quantizeReportsMaximumError();
+    quantizeClampsNonFiniteValues();
+}
@@ -0,0 +1,488 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_reorder.h"
+
+#define REORDER_VERTEX 0
+#define REORDER_UNWRAP 1
+#define REORDER_NORMAL 2
+#define REORDER_MIN_CACHE_SIZE 4
+#define REORDER_MORTON_BITS 21
+#define REORDER_RADIX_BITS 11
+
+static int faceIsOrderable(const struct WavefrontObject *obj, const struct WavefrontObjectFace *face) {
+    if(face->pointCount < 3) return 0;
+    for(unsigned int i = 0; i < face->pointCount; i++) {
+        int v = face->points[i].v;
+        if(v < 1 || (unsigned int)v > obj->vertexCount) return 0;
+    }
+    return 1;
+}
+
+double wavefrontObjectCacheMissRatio(const struct WavefrontObject *obj, unsigned int cacheSize) {
+    if(!wavefrontObjectFitsCompact(obj)) return -1;
+    // FIFO cache simulation, a vertex is cached while fewer than cacheSize misses followed its own.
+    unsigned int *timestamps = (unsigned int*)calloc(obj->vertexCount + 1, sizeof(unsigned int));
+    if(timestamps == NULL) return -1;
+    unsigned int misses = 0, triangles = 0;
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            if(!faceIsOrderable(obj, face)) continue;
+            triangles += face->pointCount - 2;
+            for(unsigned int k = 0; k < face->pointCount; k++) {
+                unsigned int v = face->points[k].v - 1;
+                if(timestamps[v] == 0 || misses - timestamps[v] >= cacheSize) {
+                    timestamps[v] = ++misses;
+                }
+            }
+        }
+    }
+    free(timestamps);
+    return triangles ? (double)misses / triangles : 0;
+}
+
+struct CacheOptimizer {
+    const struct WavefrontObject *obj;
+    unsigned int *local;
+    unsigned int cacheSize;
+};
+
+// Forsyth, Linear-Speed Vertex Cache Optimisation.
+static double vertexScore(int cachePosition, unsigned int remaining, unsigned int cacheSize) {
+    if(remaining == 0) return -1;
+    double score = 0;
+    if(cachePosition >= 0) {
+        if(cachePosition < 3) score = 0.75;
+        else score = pow(1.0 - (double)(cachePosition - 3) / (cacheSize - 3), 1.5);
+    }
+    return score + 2.0 / sqrt(remaining);
+}
+
+static int reorderObjectFaces(struct CacheOptimizer *c, struct WavefrontObjectObject *o) {
+    const struct WavefrontObject *obj = c->obj;
+    unsigned int faceCount = 0, cornerCount = 0, vertexCount = 0, maxPoints = 0;
+    for(unsigned int j = 0; j < o->faceCount; j++) {
+        const struct WavefrontObjectFace *face = o->faces + j;
+        if(!faceIsOrderable(obj, face)) continue;
+        faceCount++;
+        cornerCount += face->pointCount;
+        if(face->pointCount > maxPoints) maxPoints = face->pointCount;
+    }
+    if(faceCount < 2) return STATUS_OK;
+
+    unsigned int *faces = (unsigned int*)malloc(faceCount * sizeof(unsigned int));
+    unsigned int *faceStart = (unsigned int*)malloc((faceCount + 1) * sizeof(unsigned int));
+    unsigned int *corners = (unsigned int*)malloc(cornerCount * sizeof(unsigned int));
+    unsigned int *globals = (unsigned int*)malloc(cornerCount * sizeof(unsigned int));
+    unsigned int *remaining = (unsigned int*)calloc(cornerCount, sizeof(unsigned int));
+    unsigned int *offsets = (unsigned int*)calloc(cornerCount + 1, sizeof(unsigned int));
+    unsigned int *adjacency = (unsigned int*)malloc(cornerCount * sizeof(unsigned int));
+    int *cachePosition = (int*)malloc(cornerCount * sizeof(int));
+    double *score = (double*)malloc(cornerCount * sizeof(double));
+    unsigned char *emitted = (unsigned char*)calloc(faceCount, 1);
+    unsigned int *cache = (unsigned int*)malloc((c->cacheSize + maxPoints) * sizeof(unsigned int));
+    unsigned int *nextCache = (unsigned int*)malloc((c->cacheSize + maxPoints) * sizeof(unsigned int));
+    struct WavefrontObjectFace *ordered = (struct WavefrontObjectFace*)malloc(
+        o->faceCount * sizeof(struct WavefrontObjectFace));
+    int result = STATUS_ALLOC_ERR;
+    if(faces && faceStart && corners && globals && remaining && offsets && adjacency
+            && cachePosition && score && emitted && cache && nextCache && ordered) {
+        // Number the vertices used by this object densely.
+        unsigned int f = 0, corner = 0;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            if(!faceIsOrderable(obj, face)) continue;
+            faces[f] = j;
+            faceStart[f++] = corner;
+            for(unsigned int k = 0; k < face->pointCount; k++) {
+                unsigned int v = face->points[k].v - 1;
+                if(c->local[v] == UINT_MAX) {
+                    c->local[v] = vertexCount;
+                    globals[vertexCount++] = v;
+                }
+                unsigned int l = c->local[v];
+                corners[corner++] = l;
+                remaining[l]++;
+            }
+        }
+        faceStart[faceCount] = corner;
+        for(unsigned int l = 0; l < vertexCount; l++) {
+            c->local[globals[l]] = UINT_MAX;
+            offsets[l + 1] = offsets[l] + remaining[l];
+            cachePosition[l] = -1;
+            score[l] = vertexScore(-1, remaining[l], c->cacheSize);
+        }
+        // Reuse remaining as a fill cursor, it is recounted as faces are added.
+        for(unsigned int l = 0; l < vertexCount; l++) remaining[l] = 0;
+        for(f = 0; f < faceCount; f++) {
+            for(unsigned int k = faceStart[f]; k < faceStart[f + 1]; k++) {
+                unsigned int l = corners[k];
+                adjacency[offsets[l] + remaining[l]++] = f;
+            }
+        }
+
+        unsigned int emittedCount = 0, cursor = 0, cacheCount = 0;
+        int best = -1;
+        while(emittedCount < faceCount) {
+            if(best < 0) {
+                // Nothing adjacent to the cache is left, restart from the next unemitted face.
+                while(emitted[cursor]) cursor++;
+                best = cursor;
+            }
+            f = best;
+            emitted[f] = 1;
+            ordered[emittedCount++] = o->faces[faces[f]];
+
+            unsigned int nextCount = 0;
+            for(unsigned int k = faceStart[f]; k < faceStart[f + 1]; k++) {
+                unsigned int l = corners[k];
+                // Drop the face from the vertex's live adjacency.
+                unsigned int *live = adjacency + offsets[l];
+                for(unsigned int a = 0; a < remaining[l]; a++) {
+                    if(live[a] == f) {
+                        live[a] = live[--remaining[l]];
+                        break;
+                    }
+                }
+                if(cachePosition[l] != -2) {
+                    nextCache[nextCount++] = l;
+                    cachePosition[l] = -2;
+                }
+            }
+            for(unsigned int i = 0; i < cacheCount; i++) {
+                if(cachePosition[cache[i]] != -2) nextCache[nextCount++] = cache[i];
+            }
+            for(unsigned int i = 0; i < nextCount; i++) {
+                unsigned int l = nextCache[i];
+                cachePosition[l] = i < c->cacheSize ? (int)i : -1;
+                score[l] = vertexScore(cachePosition[l], remaining[l], c->cacheSize);
+            }
+            cacheCount = nextCount < c->cacheSize ? nextCount : c->cacheSize;
+            unsigned int *temp = cache;
+            cache = nextCache;
+            nextCache = temp;
+
+            best = -1;
+            double bestScore = -1;
+            for(unsigned int i = 0; i < cacheCount; i++) {
+                unsigned int l = cache[i];
+                for(unsigned int a = 0; a < remaining[l]; a++) {
+                    unsigned int candidate = adjacency[offsets[l] + a];
+                    double s = 0;
+                    for(unsigned int k = faceStart[candidate]; k < faceStart[candidate + 1]; k++) s += score[corners[k]];
+                    if(s > bestScore) {
+                        bestScore = s;
+                        best = candidate;
+                    }
+                }
+            }
+        }
+
+        // Faces that could not be ordered keep their relative order after the rest.
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            if(!faceIsOrderable(obj, o->faces + j)) ordered[emittedCount++] = o->faces[j];
+        }
+        // Point buffers kept in unused slots go with the old array.
+        for(unsigned int j = o->faceCount; j < o->faceCapacity; j++) wavefrontObjectFaceFree(o->faces + j);
+        free(o->faces);
+        o->faces = ordered;
+        o->faceCapacity = o->faceCount;
+        ordered = NULL;
+        result = STATUS_OK;
+    }
+    free(faces);
+    free(faceStart);
+    free(corners);
+    free(globals);
+    free(remaining);
+    free(offsets);
+    free(adjacency);
+    free(cachePosition);
+    free(score);
+    free(emitted);
+    free(cache);
+    free(nextCache);
+    free(ordered);
+    return result;
+}
+
+int wavefrontObjectReorderFaces(
+        struct WavefrontObject *obj,
+        unsigned int cacheSize,
+        struct WavefrontObjectCacheStatistics *statistics) {
+    if(!wavefrontObjectFitsCompact(obj)) return STATUS_ALLOC_ERR;
+    if(cacheSize < REORDER_MIN_CACHE_SIZE) cacheSize = REORDER_MIN_CACHE_SIZE;
+    if(statistics) statistics->acmrBefore = wavefrontObjectCacheMissRatio(obj, cacheSize);
+
+    struct CacheOptimizer c;
+    c.obj = obj;
+    c.cacheSize = cacheSize;
+    c.local = (unsigned int*)malloc((obj->vertexCount + 1) * sizeof(unsigned int));
+    if(c.local == NULL) return STATUS_ALLOC_ERR;
+    for(unsigned int v = 0; v < obj->vertexCount; v++) c.local[v] = UINT_MAX;
+
+    int result = STATUS_OK;
+    for(unsigned int i = 0; i < obj->objectCount && result == STATUS_OK; i++) {
+        result = reorderObjectFaces(&c, obj->objects + i);
+    }
+    free(c.local);
+
+    if(statistics) statistics->acmrAfter = wavefrontObjectCacheMissRatio(obj, cacheSize);
+    return result;
+}
+
+static WavefrontObjectIndex *pointIndex(struct WavefrontObjectPoint *point, int attribute) {
+    if(attribute == REORDER_VERTEX) return &point->v;
+    if(attribute == REORDER_UNWRAP) return &point->vt;
+    return &point->vn;
+}
+
+// Copy data into a new array with element i moved to remap[i].
+static void *permute(const unsigned int *remap, const void *data, unsigned int count, size_t size) {
+    char *permuted = (char*)malloc(count * size + 1);
+    if(permuted == NULL) return NULL;
+    for(unsigned int i = 0; i < count; i++) {
+        memcpy(permuted + remap[i] * size, (const char*)data + i * size, size);
+    }
+    return permuted;
+}
+
+// A relative index names the element that many back from where the face stood
+// in the file, which the object no longer records, so it cannot be remapped.
+static int hasRelativeIndices(const struct WavefrontObject *obj) {
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            for(unsigned int k = 0; k < face->pointCount; k++) {
+                const struct WavefrontObjectPoint *point = face->points + k;
+                if(point->v < 0 || point->vt < 0 || point->vn < 0) return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void remapIndex(WavefrontObjectIndex *index, const unsigned int *remap, unsigned int count) {
+    if(*index >= 1 && (unsigned int)*index <= count) *index = remap[*index - 1] + 1;
+}
+
+// Permute vertices, unwraps and normals and rewrite every face index to match, or change nothing.
+static int applyRemaps(
+        struct WavefrontObject *obj,
+        const unsigned int *vertexRemap,
+        const unsigned int *unwrapRemap,
+        const unsigned int *normalRemap) {
+    void *vertices = permute(vertexRemap, obj->vertices, obj->vertexCount, sizeof(struct WavefrontObjectVertex));
+    void *unwraps = permute(unwrapRemap, obj->unwraps, obj->unwrapCount, sizeof(struct WavefrontObjectUnwrap));
+    void *normals = permute(normalRemap, obj->normals, obj->normalCount, sizeof(struct WavefrontObjectNormal));
+    if(vertices == NULL || unwraps == NULL || normals == NULL) {
+        free(vertices);
+        free(unwraps);
+        free(normals);
+        return STATUS_ALLOC_ERR;
+    }
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            struct WavefrontObjectFace *face = o->faces + j;
+            for(unsigned int k = 0; k < face->pointCount; k++) {
+                struct WavefrontObjectPoint *point = face->points + k;
+                remapIndex(&point->v, vertexRemap, obj->vertexCount);
+                remapIndex(&point->vt, unwrapRemap, obj->unwrapCount);
+                remapIndex(&point->vn, normalRemap, obj->normalCount);
+            }
+        }
+    }
+    free(obj->vertices);
+    free(obj->unwraps);
+    free(obj->normals);
+    obj->vertices = (struct WavefrontObjectVertex*)vertices;
+    obj->unwraps = (struct WavefrontObjectUnwrap*)unwraps;
+    obj->normals = (struct WavefrontObjectNormal*)normals;
+    obj->vertexCapacity = obj->vertexCount;
+    obj->unwrapCapacity = obj->unwrapCount;
+    obj->normalCapacity = obj->normalCount;
+    return STATUS_OK;
+}
+
+// Number elements of an attribute in the order faces first reference them.
+static unsigned int *fetchRemap(const struct WavefrontObject *obj, int attribute, unsigned int count) {
+    unsigned int *remap = (unsigned int*)malloc((count + 1) * sizeof(unsigned int));
+    if(remap == NULL) return NULL;
+    for(unsigned int i = 0; i < count; i++) remap[i] = UINT_MAX;
+    unsigned int next = 0;
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            struct WavefrontObjectFace *face = o->faces + j;
+            for(unsigned int k = 0; k < face->pointCount; k++) {
+                int index = *pointIndex(face->points + k, attribute);
+                if(index >= 1 && (unsigned int)index <= count && remap[index - 1] == UINT_MAX) {
+                    remap[index - 1] = next++;
+                }
+            }
+        }
+    }
+    for(unsigned int i = 0; i < count; i++) {
+        if(remap[i] == UINT_MAX) remap[i] = next++;
+    }
+    return remap;
+}
+
+int wavefrontObjectReorderVertices(struct WavefrontObject *obj) {
+    if(!wavefrontObjectFitsCompact(obj)) return STATUS_ALLOC_ERR;
+    if(hasRelativeIndices(obj)) return STATUS_PARSE_ERR;
+    int result = STATUS_ALLOC_ERR;
+    unsigned int *vertexRemap = fetchRemap(obj, REORDER_VERTEX, obj->vertexCount);
+    unsigned int *unwrapRemap = fetchRemap(obj, REORDER_UNWRAP, obj->unwrapCount);
+    unsigned int *normalRemap = fetchRemap(obj, REORDER_NORMAL, obj->normalCount);
+    if(vertexRemap && unwrapRemap && normalRemap) {
+        result = applyRemaps(obj, vertexRemap, unwrapRemap, normalRemap);
+    }
+    free(vertexRemap);
+    free(unwrapRemap);
+    free(normalRemap);
+    return result;
+}
+
+// Interleave the low 21 bits of x with two zero bits between each.
+static unsigned long long mortonSpread(unsigned long long x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+// The grid cell of one coordinate. Non-finite coordinates go to cell 0 and the
+// rest are clamped, the cast of anything outside the grid being undefined.
+static unsigned long long mortonCell(double p, double min, double scale) {
+    const double last = (1 << REORDER_MORTON_BITS) - 1;
+    if(!isfinite(p)) return 0;
+    double cell = (p - min) * scale;
+    if(!(cell > 0)) return 0;
+    return cell >= last ? (unsigned long long)last : (unsigned long long)cell;
+}
+
+// Stable LSD radix sort of keys, returning the rank of every element.
+static unsigned int *rankKeys(const unsigned long long *keys, unsigned int count) {
+    unsigned int *order = (unsigned int*)malloc((count + 1) * sizeof(unsigned int));
+    unsigned int *temp = (unsigned int*)malloc((count + 1) * sizeof(unsigned int));
+    unsigned int *histogram = (unsigned int*)malloc((1 << REORDER_RADIX_BITS) * sizeof(unsigned int));
+    if(order == NULL || temp == NULL || histogram == NULL) {
+        free(order);
+        free(temp);
+        free(histogram);
+        return NULL;
+    }
+    for(unsigned int i = 0; i < count; i++) order[i] = i;
+    for(int shift = 0; shift < 64; shift += REORDER_RADIX_BITS) {
+        unsigned int mask = (1 << REORDER_RADIX_BITS) - 1;
+        memset(histogram, 0, (1 << REORDER_RADIX_BITS) * sizeof(unsigned int));
+        for(unsigned int i = 0; i < count; i++) histogram[(keys[i] >> shift) & mask]++;
+        unsigned int sum = 0;
+        for(unsigned int d = 0; d <= mask; d++) {
+            unsigned int bucket = histogram[d];
+            histogram[d] = sum;
+            sum += bucket;
+        }
+        for(unsigned int i = 0; i < count; i++) {
+            unsigned int element = order[i];
+            temp[histogram[(keys[element] >> shift) & mask]++] = element;
+        }
+        unsigned int *swap = order;
+        order = temp;
+        temp = swap;
+    }
+    // Invert the sorted order into ranks.
+    for(unsigned int i = 0; i < count; i++) temp[order[i]] = i;
+    free(order);
+    free(histogram);
+    return temp;
+}
+
+// Give each unwrap or normal the smallest key of the vertices it is used with.
+static unsigned long long *attributeKeys(
+        struct WavefrontObject *obj,
+        int attribute,
+        unsigned int count,
+        const unsigned long long *vertexKeys) {
+    unsigned long long *keys = (unsigned long long*)malloc((count + 1) * sizeof(unsigned long long));
+    if(keys == NULL) return NULL;
+    for(unsigned int i = 0; i < count; i++) keys[i] = ~0ULL;
+    for(unsigned int i = 0; i < obj->objectCount; i++) {
+        struct WavefrontObjectObject *o = obj->objects + i;
+        for(unsigned int j = 0; j < o->faceCount; j++) {
+            struct WavefrontObjectFace *face = o->faces + j;
+            for(unsigned int k = 0; k < face->pointCount; k++) {
+                int v = face->points[k].v;
+                int index = *pointIndex(face->points + k, attribute);
+                if(v < 1 || (unsigned int)v > obj->vertexCount) continue;
+                if(index < 1 || (unsigned int)index > count) continue;
+                if(vertexKeys[v - 1] < keys[index - 1]) keys[index - 1] = vertexKeys[v - 1];
+            }
+        }
+    }
+    return keys;
+}
+
+int wavefrontObjectReorderSpatially(struct WavefrontObject *obj) {
+    if(!wavefrontObjectFitsCompact(obj)) return STATUS_ALLOC_ERR;
+    if(hasRelativeIndices(obj)) return STATUS_PARSE_ERR;
+    if(obj->vertexCount == 0) return STATUS_OK;
+    // Bounds of the finite coordinates, a NaN or infinity would poison them.
+    double min[3] = {INFINITY, INFINITY, INFINITY}, max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for(unsigned int i = 0; i < obj->vertexCount; i++) {
+        const struct WavefrontObjectVertex *vertex = obj->vertices + i;
+        double p[3] = {vertex->x, vertex->y, vertex->z};
+        for(int c = 0; c < 3; c++) {
+            if(!isfinite(p[c])) continue;
+            if(p[c] < min[c]) min[c] = p[c];
+            if(p[c] > max[c]) max[c] = p[c];
+        }
+    }
+    // A uniform scale keeps the curve's cells cubic.
+    double extent = 0;
+    for(int c = 0; c < 3; c++) {
+        if(min[c] > max[c]) min[c] = max[c] = 0;
+        if(max[c] - min[c] > extent) extent = max[c] - min[c];
+    }
+    double scale = extent > 0 && isfinite(extent) ? ((1 << REORDER_MORTON_BITS) - 1) / extent : 0;
+
+    unsigned long long *vertexKeys = (unsigned long long*)malloc(
+        obj->vertexCount * sizeof(unsigned long long));
+    if(vertexKeys == NULL) return STATUS_ALLOC_ERR;
+    for(unsigned int i = 0; i < obj->vertexCount; i++) {
+        const struct WavefrontObjectVertex *vertex = obj->vertices + i;
+        double p[3] = {vertex->x, vertex->y, vertex->z};
+        unsigned long long key = 0;
+        for(int c = 0; c < 3; c++) {
+            key |= mortonSpread(mortonCell(p[c], min[c], scale)) << c;
+        }
+        vertexKeys[i] = key;
+    }
+
+    int result = STATUS_ALLOC_ERR;
+    unsigned long long *unwrapKeys = attributeKeys(obj, REORDER_UNWRAP, obj->unwrapCount, vertexKeys);
+    unsigned long long *normalKeys = attributeKeys(obj, REORDER_NORMAL, obj->normalCount, vertexKeys);
+    unsigned int *vertexRemap = rankKeys(vertexKeys, obj->vertexCount);
+    unsigned int *unwrapRemap = unwrapKeys ? rankKeys(unwrapKeys, obj->unwrapCount) : NULL;
+    unsigned int *normalRemap = normalKeys ? rankKeys(normalKeys, obj->normalCount) : NULL;
+    if(vertexRemap && unwrapRemap && normalRemap) {
+        result = applyRemaps(obj, vertexRemap, unwrapRemap, normalRemap);
+    }
+    free(vertexKeys);
+    free(unwrapKeys);
+    free(normalKeys);
+    free(vertexRemap);
+    free(unwrapRemap);
+    free(normalRemap);
+    return result;
+}
@@ -0,0 +1,26 @@
+#ifndef __WAVEFRONT_OBJECT_REORDER_H
+#define __WAVEFRONT_OBJECT_REORDER_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+
+// Average cache miss ratio, post transform cache misses per triangle.
+struct WavefrontObjectCacheStatistics {
+    double acmrBefore;
+    double acmrAfter;
+};
+
+double wavefrontObjectCacheMissRatio(const struct WavefrontObject *obj, unsigned int cacheSize);
+int wavefrontObjectReorderFaces(struct WavefrontObject *obj, unsigned int cacheSize, struct WavefrontObjectCacheStatistics *statistics);
+// Permute vertices, unwraps and normals, in fetch order or in Morton order of
+// the vertices, and renumber the faces to match. Objects whose faces use
+// relative negative indices are refused with STATUS_PARSE_ERR and left unchanged.
+int wavefrontObjectReorderVertices(struct WavefrontObject *obj);
+int wavefrontObjectReorderSpatially(struct WavefrontObject *obj);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
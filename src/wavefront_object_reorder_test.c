@@ -0,0 +1,241 @@
+#include <math.h>
+#include "wavefront_object_reorder.h"
+#include "wavefront_object_parser.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+// Triangulated grid whose triangles are emitted in a scrambled order.
+static void composeScrambledGrid(struct WavefrontObject *wObj, unsigned int size) {
+    wavefrontObjectCompose(wObj);
+    for(unsigned int y = 0; y <= size; y++) {
+        for(unsigned int x = 0; x <= size; x++) {
+            struct WavefrontObjectVertex vertex = {1.0, x, y, 0.0};
+            wavefrontObjectAddVertex(wObj, &vertex);
+            struct WavefrontObjectNormal normal = {0.0, x, y};
+            wavefrontObjectAddNormal(wObj, &normal);
+        }
+    }
+    unsigned int quadCount = size * size, seed = 7;
+    for(unsigned int i = 0; i < quadCount; i++) {
+        // Step through the quads with a stride coprime to their count.
+        seed = (seed + 37) % quadCount;
+        unsigned int x = seed % size, y = seed / size;
+        int corner = y * (size + 1) + x + 1;
+        int triangles[2][3] = {
+            {corner, corner + 1, corner + size + 2},
+            {corner, corner + size + 2, corner + size + 1}};
+        for(int t = 0; t < 2; t++) {
+            struct WavefrontObjectPoint points[3];
+            for(int k = 0; k < 3; k++) {
+                points[k].v = points[k].vn = triangles[t][k];
+                points[k].vt = 0;
+            }
+            struct WavefrontObjectFace *face = wavefrontObjectNextFace(wObj);
+            wavefrontObjectFaceSetPoints(face, points, 3);
+            wavefrontObjectAddFace(wObj, face);
+        }
+    }
+}
+
+static double positionChecksum(const struct WavefrontObject *wObj) {
+    double sum = 0;
+    for(unsigned int i = 0; i < wObj->objects->faceCount; i++) {
+        const struct WavefrontObjectFace *face = wObj->objects->faces + i;
+        for(unsigned int k = 0; k < face->pointCount; k++) {
+            const struct WavefrontObjectVertex *v = wObj->vertices + face->points[k].v - 1;
+            const struct WavefrontObjectNormal *n = wObj->normals + face->points[k].vn - 1;
+            sum += v->x * 3 + v->y * 5 + n->x * 7 + n->y * 11;
+        }
+    }
+    return sum;
+}
+
+void cacheMissRatioOfSingleTriangle() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 0 1 0\n\
+    f 1 2 3\n\
+    f 1 2 3\n\
+    l 1 2\n";
+    struct WavefrontObject wObj;
+    parseWavefrontObjectFromString(&wObj, input);
+    assertFloatsEqual(wavefrontObjectCacheMissRatio(&wObj, 16), 1.5);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderFacesImprovesCacheMissRatio() {
+    struct WavefrontObject wObj;
+    struct WavefrontObjectCacheStatistics statistics;
+    composeScrambledGrid(&wObj, 32);
+    double checksum = positionChecksum(&wObj);
+    int result = wavefrontObjectReorderFaces(&wObj, 16, &statistics);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.objects->faceCount, 32 * 32 * 2);
+    assertIntegersEqual(statistics.acmrBefore > 1.5, 1);
+    assertIntegersEqual(statistics.acmrAfter < 0.8, 1);
+    assertFloatsEqual(statistics.acmrAfter, wavefrontObjectCacheMissRatio(&wObj, 16));
+    assertFloatsEqual(positionChecksum(&wObj), checksum);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderFacesKeepsLinesLast() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 0 1 0\n\
+    v 1 1 0\n\
+    l 1 4\n\
+    f 1 2 3\n\
+    f 2 4 3\n";
+    struct WavefrontObject wObj;
+    parseWavefrontObjectFromString(&wObj, input);
+    wavefrontObjectReorderFaces(&wObj, 16, NULL);
+    assertIntegersEqual(wObj.objects->faceCount, 3);
+    assertIntegersEqual(wObj.objects->faces[2].pointCount, 2);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderVerticesFollowsFetchOrder() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 2 0 0\n\
+    v 3 0 0\n\
+    vt 0 0\n\
+    vt 1 0\n\
+    vt 2 0\n\
+    f 4/3 2/1 3/2\n\
+    f 3/2 2/1 1/1\n";
+    struct WavefrontObject wObj;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectReorderVertices(&wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    struct WavefrontObjectFace *faces = wObj.objects->faces;
+    assertIntegersEqual(faces[0].points[0].v, 1);
+    assertIntegersEqual(faces[0].points[1].v, 2);
+    assertIntegersEqual(faces[0].points[2].v, 3);
+    assertIntegersEqual(faces[1].points[2].v, 4);
+    assertIntegersEqual(faces[0].points[0].vt, 1);
+    assertIntegersEqual(faces[0].points[1].vt, 2);
+    assertIntegersEqual(faces[0].points[2].vt, 3);
+    assertFloatsEqual(wObj.vertices[0].x, 3);
+    assertFloatsEqual(wObj.vertices[1].x, 1);
+    assertFloatsEqual(wObj.vertices[2].x, 2);
+    assertFloatsEqual(wObj.vertices[3].x, 0);
+    assertFloatsEqual(wObj.unwraps[0].u, 2);
+    assertFloatsEqual(wObj.unwraps[1].u, 0);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderVerticesKeepsChecksum() {
+    struct WavefrontObject wObj;
+    composeScrambledGrid(&wObj, 8);
+    double checksum = positionChecksum(&wObj);
+    wavefrontObjectReorderFaces(&wObj, 16, NULL);
+    wavefrontObjectReorderVertices(&wObj);
+    assertFloatsEqual(positionChecksum(&wObj), checksum);
+    assertIntegersEqual(wObj.objects->faces->points->v, 1);
+    assertIntegersEqual(wObj.objects->faces->points->vn, 1);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderSpatiallyFollowsMortonOrder() {
+    char input[] = "\
+    v 1 1 0\n\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 0 1 0\n\
+    vt 0.5 0.5\n\
+    vt 0.9 0.9\n\
+    vt 0.1 0.1\n\
+    vn 0 0 1\n\
+    f 1/2/1 4/1/1 2/3/1\n\
+    f 2/3/1 3/1/1 1/2/1\n";
+    struct WavefrontObject wObj;
+    parseWavefrontObjectFromString(&wObj, input);
+    int result = wavefrontObjectReorderSpatially(&wObj);
+    assertIntegersEqual(result, STATUS_OK);
+    // Z order visits (0,0), (1,0), (0,1) then (1,1).
+    assertFloatsEqual(wObj.vertices[0].x, 0);
+    assertFloatsEqual(wObj.vertices[0].y, 0);
+    assertFloatsEqual(wObj.vertices[1].x, 1);
+    assertFloatsEqual(wObj.vertices[1].y, 0);
+    assertFloatsEqual(wObj.vertices[2].x, 0);
+    assertFloatsEqual(wObj.vertices[2].y, 1);
+    assertFloatsEqual(wObj.vertices[3].x, 1);
+    assertFloatsEqual(wObj.vertices[3].y, 1);
+    // Unwraps follow the vertices they are used with.
+    assertFloatsEqual(wObj.unwraps[0].u, 0.1);
+    assertFloatsEqual(wObj.unwraps[1].u, 0.5);
+    assertFloatsEqual(wObj.unwraps[2].u, 0.9);
+
+    struct WavefrontObjectPoint *points = wObj.objects->faces->points;
+    assertIntegersEqual(points[0].v, 4);
+    assertIntegersEqual(points[0].vt, 3);
+    assertIntegersEqual(points[1].v, 3);
+    assertIntegersEqual(points[1].vt, 2);
+    assertIntegersEqual(points[2].v, 1);
+    assertIntegersEqual(points[2].vt, 1);
+    assertIntegersEqual(points[2].vn, 1);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderSpatiallyPlacesNonFiniteFirst() {
+    char input[] = "\
+    v nan nan nan\n\
+    v 1 1 0\n\
+    v 0 0 0\n\
+    v inf -inf 0\n\
+    v 1 0 0\n\
+    f 1 2 3 4 5\n";
+    struct WavefrontObject wObj;
+    parseWavefrontObjectFromString(&wObj, input);
+    assertIntegersEqual(wavefrontObjectReorderSpatially(&wObj), STATUS_OK);
+    // Non-finite coordinates share cell 0 with the minimum, ties keep their order.
+    assertIntegersEqual(isnan(wObj.vertices[0].x), 1);
+    assertFloatsEqual(wObj.vertices[1].x, 0);
+    assertIntegersEqual(isinf(wObj.vertices[2].x), 1);
+    assertFloatsEqual(wObj.vertices[3].x, 1);
+    assertFloatsEqual(wObj.vertices[3].y, 0);
+    assertFloatsEqual(wObj.vertices[4].y, 1);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderSpatiallyKeepsChecksum() {
+    struct WavefrontObject wObj;
+    composeScrambledGrid(&wObj, 16);
+    double checksum = positionChecksum(&wObj);
+    assertIntegersEqual(wavefrontObjectReorderSpatially(&wObj), STATUS_OK);
+    assertFloatsEqual(positionChecksum(&wObj), checksum);
+    wavefrontObjectRelease(&wObj);
+}
+
+void reorderRefusesRelativeIndices() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 2 0 0\n\
+    vn 0 0 1\n\
+    f 3//1 1//-1 2//1\n";
+    struct WavefrontObject wObj;
+    parseWavefrontObjectFromString(&wObj, input);
+    assertIntegersEqual(wavefrontObjectReorderVertices(&wObj), STATUS_PARSE_ERR);
+    assertIntegersEqual(wavefrontObjectReorderSpatially(&wObj), STATUS_PARSE_ERR);
+    assertIntegersEqual(wObj.objects->faces->points->v, 3);
+    assertIntegersEqual(wObj.objects->faces->points[1].vn, -1);
+    assertFloatsEqual(wObj.vertices[2].x, 2);
+    wavefrontObjectRelease(&wObj);
+}
+
+void wavefrontObjectReorderTest() {
+    cacheMissRatioOfSingleTriangle();
+    reorderFacesImprovesCacheMissRatio();
+    reorderFacesKeepsLinesLast();
+    reorderVerticesFollowsFetchOrder();
+    reorderVerticesKeepsChecksum();
+    reorderSpatiallyFollowsMortonOrder();
+    reorderSpatiallyPlacesNonFiniteFirst();
+    reorderSpatiallyKeepsChecksum();
+    reorderRefusesRelativeIndices();
+}
@@ -0,0 +1,110 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "wavefront_object_scan.h"
+
+// '\n', '\v', '\f' and '\r' are 0x0A to 0x0D, so one unsigned range check
+// finds them all.
+#define SCAN_LINE_FIRST 0x0A
+#define SCAN_LINE_SPAN 3
+
+static int isLineEnd(char c) {
+    return (unsigned char)(c - SCAN_LINE_FIRST) <= SCAN_LINE_SPAN;
+}
+
+static int isFieldEnd(char c) {
+    return c == ' ' || c == '\t' || c == '\0';
+}
+
+static int isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+#if defined(__SSE2__)
+static __m128i lineEnds16(__m128i chunk) {
+    __m128i offset = _mm_sub_epi8(chunk, _mm_set1_epi8(SCAN_LINE_FIRST));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(SCAN_LINE_SPAN)), offset);
+}
+
+static __m128i fieldEnds16(__m128i chunk) {
+    return _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+        _mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+}
+
+static __m128i blanks16(__m128i chunk) {
+    return _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+}
+#endif
+
+#if defined(__AVX2__)
+static __m256i lineEnds32(__m256i chunk) {
+    __m256i offset = _mm256_sub_epi8(chunk, _mm256_set1_epi8(SCAN_LINE_FIRST));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(SCAN_LINE_SPAN)), offset);
+}
+
+static __m256i fieldEnds32(__m256i chunk) {
+    return _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+        _mm256_cmpeq_epi8(chunk, _mm256_setzero_si256()));
+}
+
+static __m256i blanks32(__m256i chunk) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+}
+#endif
+
+const char *wavefrontObjectScanLine(const char *data, const char *end) {
+#if defined(__AVX2__)
+    for(; end - data >= 32; data += 32) {
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(lineEnds32(_mm256_loadu_si256((const __m256i*)data)));
+        if(mask) return data + __builtin_ctz(mask);
+    }
+#endif
+#if defined(__SSE2__)
+    for(; end - data >= 16; data += 16) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(lineEnds16(_mm_loadu_si128((const __m128i*)data)));
+        if(mask) return data + __builtin_ctz(mask);
+    }
+#endif
+    while(data < end && !isLineEnd(*data)) data++;
+    return data;
+}
+
+const char *wavefrontObjectScanField(const char *data, const char *end) {
+#if defined(__AVX2__)
+    for(; end - data >= 32; data += 32) {
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(fieldEnds32(_mm256_loadu_si256((const __m256i*)data)));
+        if(mask) return data + __builtin_ctz(mask);
+    }
+#endif
+#if defined(__SSE2__)
+    for(; end - data >= 16; data += 16) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(fieldEnds16(_mm_loadu_si128((const __m128i*)data)));
+        if(mask) return data + __builtin_ctz(mask);
+    }
+#endif
+    while(data < end && !isFieldEnd(*data)) data++;
+    return data;
+}
+
+// Most lines start with their keyword, so try one byte before a whole chunk.
+const char *wavefrontObjectScanPastBlanks(const char *data, const char *end) {
+    if(data < end && !isBlank(*data)) return data;
+#if defined(__AVX2__)
+    for(; end - data >= 32; data += 32) {
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(blanks32(_mm256_loadu_si256((const __m256i*)data)));
+        if(mask) return data + __builtin_ctz(mask);
+    }
+#endif
+#if defined(__SSE2__)
+    for(; end - data >= 16; data += 16) {
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(blanks16(_mm_loadu_si128((const __m128i*)data))) & 0xFFFF;
+        if(mask) return data + __builtin_ctz(mask);
+    }
+#endif
+    while(data < end && isBlank(*data)) data++;
+    return data;
+}
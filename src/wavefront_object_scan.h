@@ -0,0 +1,22 @@
+#ifndef __WAVEFRONT_OBJECT_SCAN_H
+#define __WAVEFRONT_OBJECT_SCAN_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+// Delimiter search 32 bytes at a time with AVX2, 16 with SSE2, otherwise a
+// byte at a time. The instruction set is picked at compile time, build with
+// make AVX2=1 for the wider loads. Each returns the first match in
+// [data, end), or end when there is none, and reads nothing past end.
+
+// Line ends, any of ASCII_V_DELIMITERS.
+const char *wavefrontObjectScanLine(const char *data, const char *end);
+// Field ends, any of ASCII_H_DELIMITERS or the string's terminating NUL.
+const char *wavefrontObjectScanField(const char *data, const char *end);
+// Past leading ASCII_H_DELIMITERS, the first byte that is neither.
+const char *wavefrontObjectScanPastBlanks(const char *data, const char *end);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
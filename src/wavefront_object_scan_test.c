@@ -0,0 +1,82 @@
+#include <string.h>
+#include "wavefront_object_scan.h"
+#include "cutil/src/string.h"
+#include "cutil/src/assertion.h"
+
+static const char *scanLineSlowly(const char *data, const char *end) {
+    while(data < end && (*data == '\0' || !strchr(ASCII_V_DELIMITERS, *data))) data++;
+    return data;
+}
+
+static const char *scanFieldSlowly(const char *data, const char *end) {
+    while(data < end && *data && !strchr(ASCII_H_DELIMITERS, *data)) data++;
+    return data;
+}
+
+static const char *scanPastBlanksSlowly(const char *data, const char *end) {
+    while(data < end && *data && strchr(ASCII_H_DELIMITERS, *data)) data++;
+    return data;
+}
+
+void scanFindsFirstDelimiter() {
+    const char input[] = "f 1/2/3\t4//5 6\r\nv 0 0 0\n";
+    const char *end = input + sizeof(input) - 1;
+    assertIntegersEqual(wavefrontObjectScanLine(input, end) - input, 14);
+    assertIntegersEqual(wavefrontObjectScanLine(input + 15, end) - input, 15);
+    assertIntegersEqual(wavefrontObjectScanLine(input + 16, end) - input, 23);
+    assertIntegersEqual(wavefrontObjectScanField(input + 2, end) - input, 7);
+    assertIntegersEqual(wavefrontObjectScanField(input + 8, end) - input, 12);
+    assertIntegersEqual(wavefrontObjectScanLine(input, input) - input, 0);
+    assertIntegersEqual(wavefrontObjectScanField(input + 3, input + 5) - input, 5);
+    assertIntegersEqual(wavefrontObjectScanPastBlanks(input + 1, end) - input, 2);
+    assertIntegersEqual(wavefrontObjectScanPastBlanks(input + 7, end) - input, 8);
+    assertIntegersEqual(wavefrontObjectScanPastBlanks(input, end) - input, 0);
+    assertIntegersEqual(wavefrontObjectScanPastBlanks(input + 1, input + 1) - input, 1);
+}
+
+// Every delimiter at every offset either side of the 16 and 32 byte loads,
+// against the byte at a time scan.
+void scanMatchesBytewiseScan() {
+    const char delimiters[] = {'\n', '\r', '\v', '\f', ' ', '\t', '\0', '\x09', '\x0e', '\x1f', '\x21', (char)0x8a};
+    char buffer[96];
+    int mismatches = 0;
+    for(unsigned int d = 0; d < sizeof(delimiters); d++) {
+        for(unsigned int start = 0; start < 33; start++) {
+            for(unsigned int at = start; at < sizeof(buffer); at++) {
+                memset(buffer, 'x', sizeof(buffer));
+                buffer[at] = delimiters[d];
+                for(unsigned int end = start; end <= sizeof(buffer); end += 7) {
+                    mismatches += wavefrontObjectScanLine(buffer + start, buffer + end) != scanLineSlowly(buffer + start, buffer + end);
+                    mismatches += wavefrontObjectScanField(buffer + start, buffer + end) != scanFieldSlowly(buffer + start, buffer + end);
+                }
+            }
+        }
+    }
+    assertIntegersEqual(mismatches, 0);
+}
+
+// Runs of blanks ending in each kind of byte at every offset.
+void scanPastBlanksMatchesBytewiseScan() {
+    const char stops[] = {'x', '\0', '\n', '\r', (char)0x8a, (char)0xa0, '\x08', '\x0a'};
+    const char blanks[] = {' ', '\t'};
+    char buffer[96];
+    int mismatches = 0;
+    for(unsigned int s = 0; s < sizeof(stops); s++) {
+        for(unsigned int start = 0; start < 33; start++) {
+            for(unsigned int at = start; at < sizeof(buffer); at++) {
+                for(unsigned int i = 0; i < sizeof(buffer); i++) buffer[i] = blanks[i % 3 == 0];
+                buffer[at] = stops[s];
+                for(unsigned int end = start; end <= sizeof(buffer); end += 7) {
+                    mismatches += wavefrontObjectScanPastBlanks(buffer + start, buffer + end) != scanPastBlanksSlowly(buffer + start, buffer + end);
+                }
+            }
+        }
+    }
+    assertIntegersEqual(mismatches, 0);
+}
+
+void wavefrontObjectScanTest() {
+    scanFindsFirstDelimiter();
+    scanMatchesBytewiseScan();
+    scanPastBlanksMatchesBytewiseScan();
+}
@@ -0,0 +1,512 @@
+#include <stdlib.h>
+#include <math.h>
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_simplify.h"
+
+#define SIMPLIFY_UNUSED ((WavefrontObjectCount)-1)
+
+struct SimplifyTriangle {
+    struct WavefrontObjectPoint points[3];
+    WavefrontObjectCount vertices[3];
+    WavefrontObjectCount object, face, material;
+};
+
+struct SimplifyQuadric {
+    double a00, a01, a02, a11, a12, a22, b0, b1, b2, c;
+};
+
+struct SimplifyEdge {
+    WavefrontObjectCount a, b;
+};
+
+struct SimplifyCollapse {
+    double cost;
+    WavefrontObjectCount from, to;
+};
+
+// Output index of each vertex, unwrap and normal the output faces use.
+struct SimplifyRemap {
+    WavefrontObjectCount *vertices;
+    WavefrontObjectCount *unwraps;
+    WavefrontObjectCount *normals;
+};
+
+struct Simplifier {
+    const struct WavefrontObject *obj;
+    struct SimplifyTriangle *triangles;
+    struct SimplifyQuadric *quadrics;
+    unsigned char *locked;
+    unsigned char *touched;
+    WavefrontObjectCount *offsets;
+    WavefrontObjectCount *adjacency;
+    struct SimplifyCollapse *collapses;
+    WavefrontObjectCount triangleCount;
+};
+
+// malloc of count elements, NULL when the byte size would wrap.
+static void *allocArray(size_t count, size_t size) {
+    if(count > ((size_t)-1 - 1) / size) return NULL;
+    return malloc(count * size + 1);
+}
+
+static int inRange(WavefrontObjectIndex index, WavefrontObjectCount count) {
+    return index >= 1 && (WavefrontObjectCount)index <= count;
+}
+
+static void position(const struct WavefrontObject *obj, WavefrontObjectCount index, double p[3]) {
+    p[0] = obj->vertices[index].x;
+    p[1] = obj->vertices[index].y;
+    p[2] = obj->vertices[index].z;
+}
+
+static void triangleNormal(const struct WavefrontObject *obj, const WavefrontObjectCount vertices[3], double n[3]) {
+    double p0[3], p1[3], p2[3], e1[3], e2[3];
+    position(obj, vertices[0], p0);
+    position(obj, vertices[1], p1);
+    position(obj, vertices[2], p2);
+    for(int i = 0; i < 3; i++) {
+        e1[i] = p1[i] - p0[i];
+        e2[i] = p2[i] - p0[i];
+    }
+    n[0] = e1[1]*e2[2] - e1[2]*e2[1];
+    n[1] = e1[2]*e2[0] - e1[0]*e2[2];
+    n[2] = e1[0]*e2[1] - e1[1]*e2[0];
+}
+
+static void quadricAddTriangle(struct SimplifyQuadric *q, const struct WavefrontObject *obj, const WavefrontObjectCount vertices[3]) {
+    double n[3], p[3];
+    triangleNormal(obj, vertices, n);
+    double length = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+    if(length == 0) return;
+    for(int i = 0; i < 3; i++) n[i] /= length;
+    position(obj, vertices[0], p);
+    double d = -(n[0]*p[0] + n[1]*p[1] + n[2]*p[2]);
+    q->a00 += n[0]*n[0];
+    q->a01 += n[0]*n[1];
+    q->a02 += n[0]*n[2];
+    q->a11 += n[1]*n[1];
+    q->a12 += n[1]*n[2];
+    q->a22 += n[2]*n[2];
+    q->b0 += n[0]*d;
+    q->b1 += n[1]*d;
+    q->b2 += n[2]*d;
+    q->c += d*d;
+}
+
+static void quadricAdd(struct SimplifyQuadric *q, const struct SimplifyQuadric *other) {
+    q->a00 += other->a00;
+    q->a01 += other->a01;
+    q->a02 += other->a02;
+    q->a11 += other->a11;
+    q->a12 += other->a12;
+    q->a22 += other->a22;
+    q->b0 += other->b0;
+    q->b1 += other->b1;
+    q->b2 += other->b2;
+    q->c += other->c;
+}
+
+static double quadricError(const struct SimplifyQuadric *q, const double p[3]) {
+    double x = p[0], y = p[1], z = p[2];
+    double error = q->a00*x*x + 2*q->a01*x*y + 2*q->a02*x*z
+        + q->a11*y*y + 2*q->a12*y*z + q->a22*z*z
+        + 2*(q->b0*x + q->b1*y + q->b2*z) + q->c;
+    return error > 0 ? error : 0;
+}
+
+static int faceIsSimplifiable(const struct WavefrontObject *obj, const struct WavefrontObjectFace *face) {
+    if(face->pointCount < 3) return 0;
+    for(WavefrontObjectCount i = 0; i < face->pointCount; i++) {
+        if(!inRange(face->points[i].v, obj->vertexCount)) return 0;
+    }
+    return 1;
+}
+
+static int compareEdges(const void *a, const void *b) {
+    const struct SimplifyEdge *x = (const struct SimplifyEdge*)a, *y = (const struct SimplifyEdge*)b;
+    if(x->a != y->a) return x->a < y->a ? -1 : 1;
+    if(x->b != y->b) return x->b < y->b ? -1 : 1;
+    return 0;
+}
+
+static int compareCollapses(const void *a, const void *b) {
+    const struct SimplifyCollapse *x = (const struct SimplifyCollapse*)a, *y = (const struct SimplifyCollapse*)b;
+    if(x->cost != y->cost) return x->cost < y->cost ? -1 : 1;
+    return 0;
+}
+
+// Lock vertices whose corners disagree on attributes or that sit on a border or non-manifold edge.
+static int lockVertices(struct Simplifier *s) {
+    const struct WavefrontObject *obj = s->obj;
+    struct WavefrontObjectPoint *first = (struct WavefrontObjectPoint*)allocArray(
+        obj->vertexCount, sizeof(struct WavefrontObjectPoint));
+    WavefrontObjectCount *firstMaterial = (WavefrontObjectCount*)allocArray(obj->vertexCount, sizeof(WavefrontObjectCount));
+    WavefrontObjectCount *firstObject = (WavefrontObjectCount*)allocArray(obj->vertexCount, sizeof(WavefrontObjectCount));
+    struct SimplifyEdge *edges = (struct SimplifyEdge*)allocArray(
+        3 * s->triangleCount, sizeof(struct SimplifyEdge));
+    if(first == NULL || firstMaterial == NULL || firstObject == NULL || edges == NULL) {
+        free(first);
+        free(firstMaterial);
+        free(firstObject);
+        free(edges);
+        return STATUS_ALLOC_ERR;
+    }
+
+    for(WavefrontObjectCount i = 0; i < obj->vertexCount; i++) first[i].v = 0;
+    for(WavefrontObjectCount t = 0; t < s->triangleCount; t++) {
+        const struct SimplifyTriangle *tri = s->triangles + t;
+        for(int k = 0; k < 3; k++) {
+            WavefrontObjectCount v = tri->vertices[k];
+            const struct WavefrontObjectPoint *point = tri->points + k;
+            if(first[v].v == 0) {
+                first[v] = *point;
+                firstMaterial[v] = tri->material;
+                firstObject[v] = tri->object;
+            } else if(first[v].vt != point->vt || first[v].vn != point->vn
+                    || firstMaterial[v] != tri->material || firstObject[v] != tri->object) {
+                s->locked[v] = 1;
+            }
+
+            WavefrontObjectCount a = tri->vertices[k], b = tri->vertices[(k + 1) % 3];
+            edges[3*t + k].a = a < b ? a : b;
+            edges[3*t + k].b = a < b ? b : a;
+        }
+    }
+
+    qsort(edges, 3 * s->triangleCount, sizeof(struct SimplifyEdge), compareEdges);
+    for(WavefrontObjectCount i = 0; i < 3 * s->triangleCount;) {
+        WavefrontObjectCount j = i + 1;
+        while(j < 3 * s->triangleCount && compareEdges(edges + i, edges + j) == 0) j++;
+        if(j - i != 2) {
+            s->locked[edges[i].a] = 1;
+            s->locked[edges[i].b] = 1;
+        }
+        i = j;
+    }
+
+    free(first);
+    free(firstMaterial);
+    free(firstObject);
+    free(edges);
+    return STATUS_OK;
+}
+
+static void buildAdjacency(struct Simplifier *s) {
+    WavefrontObjectCount vertexCount = s->obj->vertexCount;
+    memset(s->offsets, 0, (vertexCount + 1) * sizeof(WavefrontObjectCount));
+    for(WavefrontObjectCount t = 0; t < s->triangleCount; t++) {
+        for(int k = 0; k < 3; k++) s->offsets[s->triangles[t].vertices[k] + 1]++;
+    }
+    for(WavefrontObjectCount v = 0; v < vertexCount; v++) s->offsets[v + 1] += s->offsets[v];
+    for(WavefrontObjectCount t = 0; t < s->triangleCount; t++) {
+        for(int k = 0; k < 3; k++) {
+            WavefrontObjectCount v = s->triangles[t].vertices[k];
+            s->adjacency[s->offsets[v]++] = t;
+        }
+    }
+    // Filling advanced every offset to the start of the next vertex, shift them back.
+    for(WavefrontObjectCount v = vertexCount; v > 0; v--) s->offsets[v] = s->offsets[v - 1];
+    s->offsets[0] = 0;
+}
+
+static int triangleCorner(const struct SimplifyTriangle *tri, WavefrontObjectCount vertex) {
+    for(int k = 0; k < 3; k++) {
+        if(tri->vertices[k] == vertex) return k;
+    }
+    return -1;
+}
+
+// Attempt to move vertex from onto vertex to, rejecting collapses that fold a triangle over.
+static int collapse(struct Simplifier *s, WavefrontObjectCount from, WavefrontObjectCount to) {
+    const struct WavefrontObjectPoint *target = NULL;
+    for(WavefrontObjectCount i = s->offsets[from]; i < s->offsets[from + 1]; i++) {
+        const struct SimplifyTriangle *tri = s->triangles + s->adjacency[i];
+        int corner = triangleCorner(tri, to);
+        if(corner >= 0) {
+            target = tri->points + corner;
+            break;
+        }
+    }
+    if(target == NULL) return 0;
+
+    for(WavefrontObjectCount i = s->offsets[from]; i < s->offsets[from + 1]; i++) {
+        const struct SimplifyTriangle *tri = s->triangles + s->adjacency[i];
+        if(triangleCorner(tri, to) >= 0) continue;
+        WavefrontObjectCount moved[3] = {tri->vertices[0], tri->vertices[1], tri->vertices[2]};
+        moved[triangleCorner(tri, from)] = to;
+        double before[3], after[3];
+        triangleNormal(s->obj, tri->vertices, before);
+        triangleNormal(s->obj, moved, after);
+        if(before[0]*after[0] + before[1]*after[1] + before[2]*after[2] <= 0) return 0;
+    }
+
+    struct WavefrontObjectPoint point = *target;
+    for(WavefrontObjectCount i = s->offsets[from]; i < s->offsets[from + 1]; i++) {
+        struct SimplifyTriangle *tri = s->triangles + s->adjacency[i];
+        int corner = triangleCorner(tri, from);
+        tri->vertices[corner] = to;
+        tri->points[corner] = point;
+        for(int k = 0; k < 3; k++) s->touched[tri->vertices[k]] = 1;
+    }
+    s->touched[from] = 1;
+    quadricAdd(s->quadrics + to, s->quadrics + from);
+    return 1;
+}
+
+static int isDegenerate(const struct SimplifyTriangle *tri) {
+    return tri->vertices[0] == tri->vertices[1]
+        || tri->vertices[1] == tri->vertices[2]
+        || tri->vertices[2] == tri->vertices[0];
+}
+
+static void simplify(struct Simplifier *s, WavefrontObjectCount targetTriangleCount, double targetError, double *resultError) {
+    const struct WavefrontObject *obj = s->obj;
+    while(s->triangleCount > targetTriangleCount) {
+        buildAdjacency(s);
+
+        WavefrontObjectCount collapseCount = 0;
+        for(WavefrontObjectCount t = 0; t < s->triangleCount; t++) {
+            const struct SimplifyTriangle *tri = s->triangles + t;
+            for(int k = 0; k < 3; k++) {
+                WavefrontObjectCount a = tri->vertices[k], b = tri->vertices[(k + 1) % 3];
+                for(int direction = 0; direction < 2; direction++) {
+                    WavefrontObjectCount from = direction ? b : a, to = direction ? a : b;
+                    if(s->locked[from]) continue;
+                    struct SimplifyQuadric q = s->quadrics[from];
+                    double p[3];
+                    quadricAdd(&q, s->quadrics + to);
+                    position(obj, to, p);
+                    struct SimplifyCollapse *c = s->collapses + collapseCount++;
+                    c->cost = quadricError(&q, p);
+                    c->from = from;
+                    c->to = to;
+                }
+            }
+        }
+        qsort(s->collapses, collapseCount, sizeof(struct SimplifyCollapse), compareCollapses);
+
+        // Every vertex takes part in at most one collapse per pass so adjacency stays valid.
+        memset(s->touched, 0, obj->vertexCount);
+        WavefrontObjectCount liveCount = s->triangleCount, collapsed = 0;
+        for(WavefrontObjectCount i = 0; i < collapseCount && liveCount > targetTriangleCount; i++) {
+            const struct SimplifyCollapse *c = s->collapses + i;
+            double error = sqrt(c->cost);
+            if(error > targetError) break;
+            if(s->touched[c->from] || s->touched[c->to]) continue;
+
+            WavefrontObjectCount removed = 0;
+            for(WavefrontObjectCount j = s->offsets[c->from]; j < s->offsets[c->from + 1]; j++) {
+                removed += triangleCorner(s->triangles + s->adjacency[j], c->to) >= 0;
+            }
+            if(!collapse(s, c->from, c->to)) continue;
+            liveCount -= removed;
+            collapsed++;
+            if(error > *resultError) *resultError = error;
+        }
+        if(collapsed == 0) break;
+
+        WavefrontObjectCount count = 0;
+        for(WavefrontObjectCount t = 0; t < s->triangleCount; t++) {
+            if(!isDegenerate(s->triangles + t)) s->triangles[count++] = s->triangles[t];
+        }
+        s->triangleCount = count;
+    }
+}
+
+static int addFace(
+        struct WavefrontObject *out,
+        WavefrontObjectCount object,
+        WavefrontObjectCount material,
+        const struct WavefrontObjectPoint *points,
+        WavefrontObjectCount pointCount,
+        const struct WavefrontObject *obj,
+        const struct SimplifyRemap *remap) {
+    struct WavefrontObjectFace face;
+    face.points = NULL;
+    face.pointCount = 0;
+    face.pointCapacity = 0;
+    for(WavefrontObjectCount i = 0; i < pointCount; i++) {
+        struct WavefrontObjectPoint point = points[i];
+        if(inRange(point.v, obj->vertexCount)) point.v = remap->vertices[point.v - 1] + 1;
+        if(inRange(point.vt, obj->unwrapCount)) point.vt = remap->unwraps[point.vt - 1] + 1;
+        if(inRange(point.vn, obj->normalCount)) point.vn = remap->normals[point.vn - 1] + 1;
+        if(wavefrontObjectFaceAddPoint(&face, &point)) {
+            wavefrontObjectFaceFree(&face);
+            return STATUS_ALLOC_ERR;
+        }
+    }
+    out->currentObject = object;
+    out->currentMaterial = material;
+    if(wavefrontObjectAddFace(out, &face)) {
+        wavefrontObjectFaceFree(&face);
+        return STATUS_ALLOC_ERR;
+    }
+    return STATUS_OK;
+}
+
+static void markPoints(struct SimplifyRemap *remap, const struct WavefrontObject *obj, const struct WavefrontObjectPoint *points, WavefrontObjectCount pointCount) {
+    for(WavefrontObjectCount i = 0; i < pointCount; i++) {
+        if(inRange(points[i].v, obj->vertexCount)) remap->vertices[points[i].v - 1] = 0;
+        if(inRange(points[i].vt, obj->unwrapCount)) remap->unwraps[points[i].vt - 1] = 0;
+        if(inRange(points[i].vn, obj->normalCount)) remap->normals[points[i].vn - 1] = 0;
+    }
+}
+
+// Number the marked elements of one kind in their original order.
+static WavefrontObjectCount numberMarked(WavefrontObjectCount *remap, WavefrontObjectCount count) {
+    WavefrontObjectCount next = 0;
+    for(WavefrontObjectCount i = 0; i < count; i++) {
+        if(remap[i] != SIMPLIFY_UNUSED) remap[i] = next++;
+    }
+    return next;
+}
+
+// Mark the vertices, unwraps and normals the output faces use so only those are copied.
+static void composeRemap(struct SimplifyRemap *remap, const struct WavefrontObject *obj, const struct Simplifier *s) {
+    memset(remap->vertices, 0xff, (obj->vertexCount + obj->unwrapCount + obj->normalCount) * sizeof(WavefrontObjectCount));
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            if(!faceIsSimplifiable(obj, o->faces + j)) markPoints(remap, obj, o->faces[j].points, o->faces[j].pointCount);
+        }
+    }
+    for(WavefrontObjectCount t = 0; t < s->triangleCount; t++) {
+        markPoints(remap, obj, s->triangles[t].points, 3);
+    }
+    numberMarked(remap->vertices, obj->vertexCount);
+    numberMarked(remap->unwraps, obj->unwrapCount);
+    numberMarked(remap->normals, obj->normalCount);
+}
+
+static int copyObject(struct WavefrontObject *out, const struct WavefrontObject *obj, const struct Simplifier *s, const struct SimplifyRemap *remap) {
+    for(WavefrontObjectCount i = 0; i < obj->materialLibraryCount; i++) {
+        if(wavefrontObjectAddMaterialLibrary(out, obj->materialLibraries[i])) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->materialCount; i++) {
+        if(wavefrontObjectAddMaterial(out, obj->materials[i])) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        if(wavefrontObjectAddObject(out, obj->objects[i].name)) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->vertexCount; i++) {
+        if(remap->vertices[i] != SIMPLIFY_UNUSED && wavefrontObjectAddVertex(out, obj->vertices + i)) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->unwrapCount; i++) {
+        if(remap->unwraps[i] != SIMPLIFY_UNUSED && wavefrontObjectAddUnwrap(out, obj->unwraps + i)) return STATUS_ALLOC_ERR;
+    }
+    for(WavefrontObjectCount i = 0; i < obj->normalCount; i++) {
+        if(remap->normals[i] != SIMPLIFY_UNUSED && wavefrontObjectAddNormal(out, obj->normals + i)) return STATUS_ALLOC_ERR;
+    }
+
+    // Surviving triangles are still in face order, interleave them with untouched faces.
+    WavefrontObjectCount t = 0;
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            const struct WavefrontObjectFace *face = o->faces + j;
+            if(!faceIsSimplifiable(obj, face)) {
+                if(addFace(out, i, face->material, face->points, face->pointCount, obj, remap)) return STATUS_ALLOC_ERR;
+                continue;
+            }
+            for(; t < s->triangleCount && s->triangles[t].object == i && s->triangles[t].face == j; t++) {
+                const struct SimplifyTriangle *tri = s->triangles + t;
+                struct WavefrontObjectPoint points[3];
+                for(int k = 0; k < 3; k++) {
+                    points[k] = tri->points[k];
+                    points[k].v = tri->vertices[k] + 1;
+                }
+                if(addFace(out, i, tri->material, points, 3, obj, remap)) return STATUS_ALLOC_ERR;
+            }
+        }
+    }
+    out->currentObject = obj->currentObject;
+    out->currentMaterial = obj->currentMaterial;
+    return STATUS_OK;
+}
+
+int wavefrontObjectSimplify(
+        struct WavefrontObject *out,
+        const struct WavefrontObject *obj,
+        WavefrontObjectCount targetTriangleCount,
+        double targetError,
+        double *resultError) {
+    double error = 0;
+    wavefrontObjectCompose(out);
+    if(!wavefrontObjectFitsCompact(obj)) return STATUS_ALLOC_ERR;
+
+    struct Simplifier s;
+    memset(&s, 0, sizeof(struct Simplifier));
+    s.obj = obj;
+    // Six candidate collapses per triangle must still be countable.
+    for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+        const struct WavefrontObjectObject *o = obj->objects + i;
+        for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+            if(faceIsSimplifiable(obj, o->faces + j)) s.triangleCount += o->faces[j].pointCount - 2;
+            if(s.triangleCount > (WavefrontObjectCount)WAVEFRONT_OBJECT_COUNT_MAX / 6) return STATUS_ALLOC_ERR;
+        }
+    }
+
+    int result = STATUS_ALLOC_ERR;
+    struct SimplifyRemap remap;
+    s.triangles = (struct SimplifyTriangle*)allocArray(s.triangleCount, sizeof(struct SimplifyTriangle));
+    s.quadrics = (struct SimplifyQuadric*)calloc(obj->vertexCount + 1, sizeof(struct SimplifyQuadric));
+    s.locked = (unsigned char*)calloc(obj->vertexCount + 1, 1);
+    s.touched = (unsigned char*)malloc(obj->vertexCount + 1);
+    s.offsets = (WavefrontObjectCount*)allocArray(obj->vertexCount + 1, sizeof(WavefrontObjectCount));
+    s.adjacency = (WavefrontObjectCount*)allocArray(3 * s.triangleCount, sizeof(WavefrontObjectCount));
+    s.collapses = (struct SimplifyCollapse*)allocArray(6 * s.triangleCount, sizeof(struct SimplifyCollapse));
+    remap.vertices = (WavefrontObjectCount*)allocArray(
+        (size_t)obj->vertexCount + obj->unwrapCount + obj->normalCount, sizeof(WavefrontObjectCount));
+    if(s.triangles && s.quadrics && s.locked && s.touched && s.offsets && s.adjacency && s.collapses && remap.vertices) {
+        remap.unwraps = remap.vertices + obj->vertexCount;
+        remap.normals = remap.unwraps + obj->unwrapCount;
+        WavefrontObjectCount t = 0;
+        for(WavefrontObjectCount i = 0; i < obj->objectCount; i++) {
+            const struct WavefrontObjectObject *o = obj->objects + i;
+            for(WavefrontObjectCount j = 0; j < o->faceCount; j++) {
+                const struct WavefrontObjectFace *face = o->faces + j;
+                if(!faceIsSimplifiable(obj, face)) continue;
+                for(WavefrontObjectCount k = 2; k < face->pointCount; k++, t++) {
+                    struct SimplifyTriangle *tri = s.triangles + t;
+                    tri->points[0] = face->points[0];
+                    tri->points[1] = face->points[k - 1];
+                    tri->points[2] = face->points[k];
+                    for(int c = 0; c < 3; c++) tri->vertices[c] = tri->points[c].v - 1;
+                    tri->object = i;
+                    tri->face = j;
+                    tri->material = face->material;
+                    for(int c = 0; c < 3; c++) quadricAddTriangle(s.quadrics + tri->vertices[c], obj, tri->vertices);
+                }
+            }
+        }
+        // Drop triangles that were degenerate to begin with.
+        WavefrontObjectCount count = 0;
+        for(t = 0; t < s.triangleCount; t++) {
+            if(!isDegenerate(s.triangles + t)) s.triangles[count++] = s.triangles[t];
+        }
+        s.triangleCount = count;
+
+        result = lockVertices(&s);
+        if(result == STATUS_OK) {
+            simplify(&s, targetTriangleCount, targetError, &error);
+            composeRemap(&remap, obj, &s);
+            result = copyObject(out, obj, &s, &remap);
+        }
+    }
+    free(s.triangles);
+    free(s.quadrics);
+    free(s.locked);
+    free(s.touched);
+    free(s.offsets);
+    free(s.adjacency);
+    free(s.collapses);
+    free(remap.vertices);
+
+    if(result) {
+        wavefrontObjectRelease(out);
+        return result;
+    }
+    if(resultError) *resultError = error;
+    return STATUS_OK;
+}
@@ -0,0 +1,28 @@
+#ifndef __WAVEFRONT_OBJECT_SIMPLIFY_H
+#define __WAVEFRONT_OBJECT_SIMPLIFY_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+
+// Decimate the faces of obj into out using quadric error metric edge collapses.
+// Collapses stop once out holds at most targetTriangleCount triangles or the next
+// collapse would move the surface by more than targetError. Pass zero and HUGE_VAL
+// respectively to leave either bound open. Vertices on mesh borders, UV seams,
+// normal creases and material or object boundaries are never moved.
+// The largest error introduced is written to resultError when it is not NULL.
+// out holds only the vertices, unwraps and normals its faces still use, renumbered
+// in their original order. Indices outside 1 to the element count, relative negative
+// ones included, are copied unchanged.
+int wavefrontObjectSimplify(
+    struct WavefrontObject *out,
+    const struct WavefrontObject *obj,
+    WavefrontObjectCount targetTriangleCount,
+    double targetError,
+    double *resultError);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
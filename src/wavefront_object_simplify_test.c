@@ -0,0 +1,183 @@
+#include <math.h>
+#include "wavefront_object_simplify.h"
+#include "wavefront_object_parser.h"
+#include "wavefront_object_fixture.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+static unsigned int triangleCount(const struct WavefrontObject *wObj) {
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < wObj->objectCount; i++) {
+        for(unsigned int j = 0; j < wObj->objects[i].faceCount; j++) {
+            count += wObj->objects[i].faces[j].pointCount - 2;
+        }
+    }
+    return count;
+}
+
+static double faceArea(const struct WavefrontObject *wObj, const struct WavefrontObjectFace *face) {
+    const struct WavefrontObjectVertex *a = wObj->vertices + face->points[0].v - 1;
+    const struct WavefrontObjectVertex *b = wObj->vertices + face->points[1].v - 1;
+    const struct WavefrontObjectVertex *c = wObj->vertices + face->points[2].v - 1;
+    return ((b->x - a->x) * (c->y - a->y) - (b->y - a->y) * (c->x - a->x)) / 2;
+}
+
+void simplifyFlatGridReachesTarget() {
+    struct WavefrontObject wObj, simplified;
+    composeGrid(&wObj, 8, 8);
+    double error = -1;
+    int result = wavefrontObjectSimplify(&simplified, &wObj, 64, HUGE_VAL, &error);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(triangleCount(&simplified) <= 64, 1);
+    assertFloatsEqual(error, 0.0);
+    assertIntegersEqual(simplified.objectCount, 1);
+    assertStringsEqual(simplified.objects->name, "grid");
+    assertIntegersEqual(simplified.vertexCount < wObj.vertexCount, 1);
+
+    // Collapses on a plane must neither fold nor open the surface.
+    double area = 0;
+    for(unsigned int i = 0; i < simplified.objects->faceCount; i++) {
+        double faceAreaValue = faceArea(&simplified, simplified.objects->faces + i);
+        assertIntegersEqual(faceAreaValue > 0, 1);
+        area += faceAreaValue;
+    }
+    assertFloatsEqual(area, 64.0);
+    wavefrontObjectRelease(&simplified);
+    wavefrontObjectRelease(&wObj);
+}
+
+void simplifyKeepsMaterialBoundaries() {
+    struct WavefrontObject wObj, simplified;
+    composeGrid(&wObj, 8, 4);
+    wavefrontObjectSimplify(&simplified, &wObj, 0, HUGE_VAL, NULL);
+    assertIntegersEqual(triangleCount(&simplified) < triangleCount(&wObj), 1);
+    assertIntegersEqual(simplified.materialCount, 2);
+
+    int crossing = 0;
+    for(unsigned int i = 0; i < simplified.objects->faceCount; i++) {
+        const struct WavefrontObjectFace *face = simplified.objects->faces + i;
+        for(unsigned int k = 0; k < face->pointCount; k++) {
+            double x = simplified.vertices[face->points[k].v - 1].x;
+            crossing += face->material == 0 ? x > 4 : x < 4;
+        }
+    }
+    assertIntegersEqual(crossing, 0);
+    wavefrontObjectRelease(&simplified);
+    wavefrontObjectRelease(&wObj);
+}
+
+void simplifyKeepsUnwrapSeams() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 2 0 0\n\
+    v 0 1 0\n\
+    v 1 1 0\n\
+    v 2 1 0\n\
+    vt 0 0\n\
+    vt 1 0\n\
+    f 1/1 2/2 5/2 4/1\n\
+    f 2/1 3/2 6/2 5/1\n";
+    struct WavefrontObject wObj, simplified;
+    parseWavefrontObjectFromString(&wObj, input);
+    wavefrontObjectSimplify(&simplified, &wObj, 0, HUGE_VAL, NULL);
+    // Every vertex is on the border or the seam so nothing may collapse.
+    assertIntegersEqual(triangleCount(&simplified), 4);
+    wavefrontObjectRelease(&simplified);
+    wavefrontObjectRelease(&wObj);
+}
+
+void simplifyRespectsErrorBound() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 2 0 0\n\
+    v 0 1 0\n\
+    v 1 1 1\n\
+    v 2 1 0\n\
+    v 0 2 0\n\
+    v 1 2 0\n\
+    v 2 2 0\n\
+    f 1 2 5\n\
+    f 2 3 5\n\
+    f 3 6 5\n\
+    f 6 9 5\n\
+    f 9 8 5\n\
+    f 8 7 5\n\
+    f 7 4 5\n\
+    f 4 1 5\n\
+    l 1 9\n";
+    struct WavefrontObject wObj, simplified;
+    parseWavefrontObjectFromString(&wObj, input);
+    double error = -1;
+    wavefrontObjectSimplify(&simplified, &wObj, 0, 0.1, &error);
+    assertIntegersEqual(triangleCount(&simplified), 8);
+    assertFloatsEqual(error, 0.0);
+    wavefrontObjectRelease(&simplified);
+
+    wavefrontObjectSimplify(&simplified, &wObj, 0, HUGE_VAL, &error);
+    assertIntegersEqual(simplified.objects->faceCount, 7);
+    assertIntegersEqual(error > 0.1, 1);
+    // Lines are passed through untouched.
+    assertIntegersEqual(simplified.objects->faces[6].pointCount, 2);
+    wavefrontObjectRelease(&simplified);
+    wavefrontObjectRelease(&wObj);
+}
+
+void simplifyDropsUnusedElements() {
+    char input[] = "\
+    v 0 0 0\n\
+    v 1 0 0\n\
+    v 2 0 0\n\
+    v 0 1 0\n\
+    v 1 1 0\n\
+    v 2 1 0\n\
+    v 0 2 0\n\
+    v 1 2 0\n\
+    v 2 2 0\n\
+    v 5 5 5\n\
+    vt 0 0\n\
+    vn 1 0 0\n\
+    vn 0 0 1\n\
+    f 1//2 2//2 5//2\n\
+    f 2//2 3//2 5//2\n\
+    f 3//2 6//2 5//2\n\
+    f 6//2 9//2 5//2\n\
+    f 9//2 8//2 5//2\n\
+    f 8//2 7//2 5//2\n\
+    f 7//2 4//2 5//2\n\
+    f 4//2 1//2 5//2\n\
+    l 9 1\n";
+    struct WavefrontObject wObj, simplified;
+    parseWavefrontObjectFromString(&wObj, input);
+    assertIntegersEqual(wavefrontObjectSimplify(&simplified, &wObj, 0, HUGE_VAL, NULL), STATUS_OK);
+    // The centre collapses and, like the stray vertex, unwrap and normal, is left out.
+    assertIntegersEqual(simplified.objects->faceCount, 7);
+    assertIntegersEqual(simplified.vertexCount, 8);
+    assertIntegersEqual(simplified.unwrapCount, 0);
+    assertIntegersEqual(simplified.normalCount, 1);
+    assertFloatsEqual(simplified.normals->z, 1.0);
+    assertFloatsEqual(simplified.vertices[7].x, 2.0);
+    assertFloatsEqual(simplified.vertices[7].y, 2.0);
+
+    int outside = 0;
+    for(unsigned int i = 0; i < 6; i++) {
+        const struct WavefrontObjectFace *face = simplified.objects->faces + i;
+        for(unsigned int k = 0; k < face->pointCount; k++) {
+            outside += face->points[k].v < 1 || face->points[k].v > 8 || face->points[k].vn != 1;
+        }
+    }
+    assertIntegersEqual(outside, 0);
+    assertIntegersEqual(simplified.objects->faces[6].points[0].v, 8);
+    assertIntegersEqual(simplified.objects->faces[6].points[1].v, 1);
+    wavefrontObjectRelease(&simplified);
+    wavefrontObjectRelease(&wObj);
+}
+
+void wavefrontObjectSimplifyTest() {
+    simplifyFlatGridReachesTarget();
+    simplifyKeepsMaterialBoundaries();
+    simplifyKeepsUnwrapSeams();
+    simplifyRespectsErrorBound();
+    simplifyDropsUnusedElements();
+}
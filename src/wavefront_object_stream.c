@@ -0,0 +1,295 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <zlib.h>
+#ifdef COBJ_ZSTD
+#include <zstd.h>
+#endif
+#include "cutil/src/error.h"
+#include "cutil/src/string.h"
+#include "wavefront_object_parser.h"
+#include "wavefront_object_stream.h"
+
+#define STREAM_BLOCK_SIZE (1 << 16)
+#define STREAM_BLOCK_COUNT 4
+
+// Blocks are decoded on a second thread while the calling thread parses the previous ones.
+struct StreamQueue {
+    char *blocks[STREAM_BLOCK_COUNT];
+    long sizes[STREAM_BLOCK_COUNT];
+    unsigned int head, count;
+    int done, failed, cancelled;
+    WavefrontObjectReader read;
+    void *context;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+};
+
+static void *decodeBlocks(void *arg) {
+    struct StreamQueue *queue = (struct StreamQueue*)arg;
+    pthread_mutex_lock(&queue->mutex);
+    while(!queue->cancelled) {
+        if(queue->count == STREAM_BLOCK_COUNT) {
+            pthread_cond_wait(&queue->changed, &queue->mutex);
+            continue;
+        }
+        // The slot after the queued blocks belongs to this thread until it is counted.
+        unsigned int tail = (queue->head + queue->count) % STREAM_BLOCK_COUNT;
+        pthread_mutex_unlock(&queue->mutex);
+        long size = queue->read(queue->context, queue->blocks[tail], STREAM_BLOCK_SIZE);
+        pthread_mutex_lock(&queue->mutex);
+        if(size <= 0) {
+            queue->failed = size < 0;
+            break;
+        }
+        queue->sizes[tail] = size;
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    queue->done = 1;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->mutex);
+    return NULL;
+}
+
+static int parseQueued(
+        struct WavefrontObjectParser *parser,
+        struct WavefrontObject *obj,
+        WavefrontObjectReader read,
+        void *context) {
+    wavefrontObjectCompose(obj);
+    wavefrontObjectParserBegin(parser);
+
+    struct StreamQueue queue;
+    memset(&queue, 0, sizeof(struct StreamQueue));
+    queue.read = read;
+    queue.context = context;
+    for(int i = 0; i < STREAM_BLOCK_COUNT; i++) {
+        queue.blocks[i] = (char*)malloc(STREAM_BLOCK_SIZE);
+        if(queue.blocks[i] == NULL) {
+            for(int j = 0; j < i; j++) free(queue.blocks[j]);
+            return STATUS_ALLOC_ERR;
+        }
+    }
+    pthread_mutex_init(&queue.mutex, NULL);
+    pthread_cond_init(&queue.changed, NULL);
+
+    int result = STATUS_OK;
+    pthread_t thread;
+    if(pthread_create(&thread, NULL, decodeBlocks, &queue)) {
+        for(int i = 0; i < STREAM_BLOCK_COUNT; i++) free(queue.blocks[i]);
+        pthread_mutex_destroy(&queue.mutex);
+        pthread_cond_destroy(&queue.changed);
+        return STATUS_ALLOC_ERR;
+    }
+
+    pthread_mutex_lock(&queue.mutex);
+    while(result == STATUS_OK) {
+        if(queue.count == 0) {
+            if(queue.done) break;
+            pthread_cond_wait(&queue.changed, &queue.mutex);
+            continue;
+        }
+        unsigned int head = queue.head;
+        pthread_mutex_unlock(&queue.mutex);
+        result = wavefrontObjectParserParseBlock(parser, obj, queue.blocks[head], queue.sizes[head]);
+        pthread_mutex_lock(&queue.mutex);
+        queue.head = (queue.head + 1) % STREAM_BLOCK_COUNT;
+        queue.count--;
+        pthread_cond_broadcast(&queue.changed);
+    }
+    if(result == STATUS_OK && queue.failed) result = STATUS_PARSE_ERR;
+    queue.cancelled = 1;
+    pthread_cond_broadcast(&queue.changed);
+    pthread_mutex_unlock(&queue.mutex);
+    pthread_join(thread, NULL);
+
+    // The input need not end with a line delimiter.
+    if(result == STATUS_OK) result = wavefrontObjectParserFinish(parser, obj);
+
+    for(int i = 0; i < STREAM_BLOCK_COUNT; i++) free(queue.blocks[i]);
+    pthread_mutex_destroy(&queue.mutex);
+    pthread_cond_destroy(&queue.changed);
+    if(result) wavefrontObjectRelease(obj);
+    return result;
+}
+
+int parseWavefrontObjectFromReader(
+        struct WavefrontObject *obj,
+        WavefrontObjectReader read,
+        void *context) {
+    struct WavefrontObjectParser parser;
+    wavefrontObjectParserCompose(&parser);
+    int result = parseQueued(&parser, obj, read, context);
+    wavefrontObjectParserRelease(&parser);
+    return result;
+}
+
+// Read and parse on the calling thread, reusing the parser's block buffer.
+static int readBlocks(
+        struct WavefrontObjectParser *parser,
+        const struct WavefrontObjectCallbacks *callbacks,
+        void *context,
+        WavefrontObjectReader read,
+        void *readContext) {
+    wavefrontObjectParserBegin(parser);
+    if(parser->block == NULL) {
+        parser->block = (char*)malloc(STREAM_BLOCK_SIZE);
+        if(parser->block == NULL) return STATUS_ALLOC_ERR;
+    }
+    int result = STATUS_OK;
+    long size = 0;
+    while(result == STATUS_OK && (size = read(readContext, parser->block, STREAM_BLOCK_SIZE)) > 0) {
+        result = wavefrontObjectParserParseBlockCallbacks(parser, callbacks, context, parser->block, size);
+    }
+    if(result == STATUS_OK && size < 0) result = STATUS_PARSE_ERR;
+    if(result == STATUS_OK) result = wavefrontObjectParserFinishCallbacks(parser, callbacks, context);
+    return result;
+}
+
+int wavefrontObjectParserParseReader(
+        struct WavefrontObjectParser *parser,
+        struct WavefrontObject *obj,
+        WavefrontObjectReader read,
+        void *context) {
+    wavefrontObjectCompose(obj);
+    int result = readBlocks(parser, &wavefrontObjectBuilder, obj, read, context);
+    if(result) wavefrontObjectRelease(obj);
+    return result;
+}
+
+// zlib reads gzip and zlib streams and passes anything else through unchanged.
+static long readGzip(void *context, char *buffer, unsigned long size) {
+    int read = gzread((gzFile)context, buffer, (unsigned int)size);
+    return read < 0 ? -1 : read;
+}
+
+#ifdef COBJ_ZSTD
+struct ZstdReader {
+    FILE *file;
+    ZSTD_DCtx *context;
+    ZSTD_inBuffer input;
+    char *inputData;
+    size_t inputCapacity;
+    int frameEnded;
+};
+
+static long readZstd(void *context, char *buffer, unsigned long size) {
+    struct ZstdReader *reader = (struct ZstdReader*)context;
+    ZSTD_outBuffer output = {buffer, size, 0};
+    while(output.pos == 0) {
+        int drained = 0;
+        if(reader->input.pos == reader->input.size) {
+            size_t read = fread(reader->inputData, 1, reader->inputCapacity, reader->file);
+            if(ferror(reader->file)) return -1;
+            if(read == 0 && reader->frameEnded) return 0;
+            // Out of input mid frame, the decoder may still hold output from
+            // a call that filled the buffer. Only a call yielding none is an error.
+            drained = read == 0;
+            reader->input.src = reader->inputData;
+            reader->input.size = read;
+            reader->input.pos = 0;
+        }
+        size_t remaining = ZSTD_decompressStream(reader->context, &output, &reader->input);
+        if(ZSTD_isError(remaining)) return -1;
+        reader->frameEnded = remaining == 0;
+        if(drained && output.pos == 0) return reader->frameEnded ? 0 : -1;
+    }
+    return (long)output.pos;
+}
+
+#endif
+
+// A decoder over an open file, zstd when the magic says so and zlib otherwise.
+struct StreamFile {
+    WavefrontObjectReader read;
+    void *context;
+    gzFile gz;
+#ifdef COBJ_ZSTD
+    FILE *file;
+    struct ZstdReader zstd;
+#endif
+};
+
+static int streamFileOpen(struct StreamFile *stream, const char *path) {
+    memset(stream, 0, sizeof(struct StreamFile));
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) return WAVEFRONT_OBJECT_STATUS_OPEN_ERR;
+    unsigned char magic[4] = {0, 0, 0, 0};
+    size_t magicSize = fread(magic, 1, sizeof(magic), file);
+    int zstd = magicSize == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd;
+#ifdef COBJ_ZSTD
+    if(zstd) {
+        rewind(file);
+        stream->file = file;
+        stream->zstd.file = file;
+        stream->zstd.context = ZSTD_createDCtx();
+        stream->zstd.inputCapacity = ZSTD_DStreamInSize();
+        stream->zstd.inputData = (char*)malloc(stream->zstd.inputCapacity);
+        stream->read = readZstd;
+        stream->context = &stream->zstd;
+        return stream->zstd.context && stream->zstd.inputData ? STATUS_OK : STATUS_ALLOC_ERR;
+    }
+#endif
+    fclose(file);
+    // Zstandard input needs a build with COBJ_ZSTD.
+    if(zstd) return STATUS_PARSE_ERR;
+
+    stream->gz = gzopen(path, "rb");
+    if(stream->gz == NULL) return WAVEFRONT_OBJECT_STATUS_OPEN_ERR;
+    gzbuffer(stream->gz, STREAM_BLOCK_SIZE);
+    stream->read = readGzip;
+    stream->context = stream->gz;
+    return STATUS_OK;
+}
+
+// Truncated gzip members only surface when the stream is closed.
+static int streamFileClose(struct StreamFile *stream) {
+    int result = STATUS_OK;
+    if(stream->gz && gzclose_r(stream->gz) != Z_OK) result = STATUS_PARSE_ERR;
+#ifdef COBJ_ZSTD
+    free(stream->zstd.inputData);
+    ZSTD_freeDCtx(stream->zstd.context);
+    if(stream->file) fclose(stream->file);
+#endif
+    return result;
+}
+
+int parseWavefrontObjectFromFile(struct WavefrontObject *obj, const char *path) {
+    wavefrontObjectCompose(obj);
+    struct StreamFile stream;
+    int result = streamFileOpen(&stream, path);
+    if(result == STATUS_OK) result = parseWavefrontObjectFromReader(obj, stream.read, stream.context);
+    if(streamFileClose(&stream) && result == STATUS_OK) {
+        wavefrontObjectRelease(obj);
+        result = STATUS_PARSE_ERR;
+    }
+    return result;
+}
+
+int wavefrontObjectParserParseFileCallbacks(
+        struct WavefrontObjectParser *parser,
+        const struct WavefrontObjectCallbacks *callbacks,
+        void *context,
+        const char *path) {
+    struct StreamFile stream;
+    int result = streamFileOpen(&stream, path);
+    if(result == STATUS_OK) result = readBlocks(parser, callbacks, context, stream.read, stream.context);
+    if(streamFileClose(&stream) && result == STATUS_OK) result = STATUS_PARSE_ERR;
+    return result;
+}
+
+int wavefrontObjectParserParseFile(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *path) {
+    wavefrontObjectCompose(obj);
+    int result = wavefrontObjectParserParseFileCallbacks(parser, &wavefrontObjectBuilder, obj, path);
+    if(result) wavefrontObjectRelease(obj);
+    return result;
+}
+
+// Like wavefrontObjectParserParseStringInto, obj is reset and keeps its buffers.
+int wavefrontObjectParserParseFileInto(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *path) {
+    wavefrontObjectReset(obj);
+    int result = wavefrontObjectParserParseFileCallbacks(parser, &wavefrontObjectBuilder, obj, path);
+    if(result) wavefrontObjectReset(obj);
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef __WAVEFRONT_OBJECT_STREAM_H
+#define __WAVEFRONT_OBJECT_STREAM_H
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "wavefront_object.h"
+#include "wavefront_object_parser.h"
+
+// Fill buffer with up to size bytes of text, returning the count written,
+// zero at the end of input or a negative value when the input is unreadable.
+typedef long (*WavefrontObjectReader)(void *context, char *buffer, unsigned long size);
+
+// The file functions read plain, gzip and, when built with COBJ_ZSTD, zstd
+// files. A path that cannot be opened gives WAVEFRONT_OBJECT_STATUS_OPEN_ERR.
+// Bad content, a truncated or corrupt stream and zstd input without COBJ_ZSTD
+// give STATUS_PARSE_ERR.
+#define WAVEFRONT_OBJECT_STATUS_OPEN_ERR 3
+
+int parseWavefrontObjectFromReader(struct WavefrontObject *obj, WavefrontObjectReader read, void *context);
+int parseWavefrontObjectFromFile(struct WavefrontObject *obj, const char *path);
+int wavefrontObjectParserParseReader(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, WavefrontObjectReader read, void *context);
+int wavefrontObjectParserParseFileCallbacks(struct WavefrontObjectParser *parser, const struct WavefrontObjectCallbacks *callbacks, void *context, const char *path);
+int wavefrontObjectParserParseFile(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *path);
+int wavefrontObjectParserParseFileInto(struct WavefrontObjectParser *parser, struct WavefrontObject *obj, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <zlib.h>
+#ifdef COBJ_ZSTD
+#include <zstd.h>
+#endif
+#include "wavefront_object_stream.h"
+#include "cutil/src/error.h"
+#include "cutil/src/assertion.h"
+
+struct MemoryReader {
+    const char *data;
+    unsigned long size, position, chunk;
+};
+
+static long readMemory(void *context, char *buffer, unsigned long size) {
+    struct MemoryReader *reader = (struct MemoryReader*)context;
+    unsigned long count = reader->size - reader->position;
+    if(count > reader->chunk) count = reader->chunk;
+    if(count > size) count = size;
+    memcpy(buffer, reader->data + reader->position, count);
+    reader->position += count;
+    return count;
+}
+
+static long readFailure(void *context, char *buffer, unsigned long size) {
+    return -1;
+}
+
+static const char streamInput[] = "\
+o test_object\r\n\
+v 1.00 2.00 3.00\n\
+v 4.00 5.00 6.00\n\
+vt 0.1 0.2 0.3\n\
+vn 0.4 0.5 0.6\n\
+usemtl test_material\n\
+f 1/1/1 2/1/1 1/1/1\n\
+f 2/1/1 1/1/1 2/1/1";
+
+static void assertStreamInput(struct WavefrontObject *wObj) {
+    assertIntegersEqual(wObj->objectCount, 1);
+    assertStringsEqual(wObj->objects->name, "test_object");
+    assertIntegersEqual(wObj->vertexCount, 2);
+    assertFloatsEqual(wObj->vertices[1].z, 6.0);
+    assertIntegersEqual(wObj->unwrapCount, 1);
+    assertIntegersEqual(wObj->normalCount, 1);
+    assertFloatsEqual(wObj->normals->y, 0.5);
+    assertIntegersEqual(wObj->materialCount, 1);
+    assertIntegersEqual(wObj->objects->faceCount, 2);
+    assertIntegersEqual(wObj->objects->faces[1].points[2].v, 2);
+}
+
+void streamParsesLinesSplitAcrossBlocks() {
+    struct MemoryReader reader = {streamInput, sizeof(streamInput) - 1, 0, 3};
+    struct WavefrontObject wObj;
+    int result = parseWavefrontObjectFromReader(&wObj, readMemory, &reader);
+    assertIntegersEqual(result, STATUS_OK);
+    assertStreamInput(&wObj);
+    wavefrontObjectRelease(&wObj);
+}
+
+void streamParsesManyBlocks() {
+    unsigned int lineCount = 50000;
+    char *input = (char*)malloc(lineCount * 16);
+    unsigned long size = 0;
+    for(unsigned int i = 0; i < lineCount; i++) {
+        size += sprintf(input + size, "v %u 0 0\n", i);
+    }
+    struct MemoryReader reader = {input, size, 0, size};
+    struct WavefrontObject wObj;
+    int result = parseWavefrontObjectFromReader(&wObj, readMemory, &reader);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.vertexCount, lineCount);
+    assertFloatsEqual(wObj.vertices[lineCount - 1].x, lineCount - 1);
+    wavefrontObjectRelease(&wObj);
+    free(input);
+}
+
+void streamFailsOnBadLine() {
+    const char input[] = "v 1 2 3\nv 1 2\nv 1 2 3\n";
+    struct MemoryReader reader = {input, sizeof(input) - 1, 0, 4};
+    struct WavefrontObject wObj;
+    int result = parseWavefrontObjectFromReader(&wObj, readMemory, &reader);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+}
+
+void streamFailsOnReaderError() {
+    struct WavefrontObject wObj;
+    int result = parseWavefrontObjectFromReader(&wObj, readFailure, NULL);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+}
+
+void streamParsesPlainAndGzipFiles() {
+    const char *plainPath = "bin/stream_test.obj", *gzipPath = "bin/stream_test.obj.gz";
+    FILE *file = fopen(plainPath, "wb");
+    fwrite(streamInput, 1, sizeof(streamInput) - 1, file);
+    fclose(file);
+    gzFile gz = gzopen(gzipPath, "wb");
+    gzwrite(gz, streamInput, sizeof(streamInput) - 1);
+    gzclose(gz);
+
+    struct WavefrontObject wObj;
+    int result = parseWavefrontObjectFromFile(&wObj, plainPath);
+    assertIntegersEqual(result, STATUS_OK);
+    assertStreamInput(&wObj);
+    wavefrontObjectRelease(&wObj);
+
+    result = parseWavefrontObjectFromFile(&wObj, gzipPath);
+    assertIntegersEqual(result, STATUS_OK);
+    assertStreamInput(&wObj);
+    wavefrontObjectRelease(&wObj);
+
+    // Cut the member short of its trailer.
+    file = fopen(gzipPath, "rb");
+    char compressed[256];
+    size_t size = fread(compressed, 1, sizeof(compressed), file);
+    fclose(file);
+    file = fopen(gzipPath, "wb");
+    fwrite(compressed, 1, size - 6, file);
+    fclose(file);
+    result = parseWavefrontObjectFromFile(&wObj, gzipPath);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+
+    remove(plainPath);
+    remove(gzipPath);
+    result = parseWavefrontObjectFromFile(&wObj, plainPath);
+    assertIntegersEqual(result, WAVEFRONT_OBJECT_STATUS_OPEN_ERR);
+}
+
+#ifdef COBJ_ZSTD
+// Larger than both the decoder's input buffer and the parser's block, so the
+// frame is read and flushed over many calls.
+void streamParsesZstdFile() {
+    const char *path = "bin/stream_test.obj.zst";
+    unsigned int lineCount = 100000;
+    char *input = (char*)malloc(lineCount * 32);
+    unsigned long size = 0;
+    for(unsigned int i = 0; i < lineCount; i++) size += sprintf(input + size, "v %u %u 3\n", i * 7919 % 10007, i);
+    size_t bound = ZSTD_compressBound(size);
+    char *compressed = (char*)malloc(bound);
+    size_t compressedSize = ZSTD_compress(compressed, bound, input, size, 19);
+    assertIntegersEqual(ZSTD_isError(compressedSize), 0);
+    FILE *file = fopen(path, "wb");
+    fwrite(compressed, 1, compressedSize, file);
+    fclose(file);
+
+    struct WavefrontObject wObj;
+    int result = parseWavefrontObjectFromFile(&wObj, path);
+    assertIntegersEqual(result, STATUS_OK);
+    assertIntegersEqual(wObj.vertexCount, lineCount);
+    assertFloatsEqual(wObj.vertices[lineCount - 1].z, 3.0);
+    wavefrontObjectRelease(&wObj);
+
+    // Cut the frame short.
+    file = fopen(path, "wb");
+    fwrite(compressed, 1, compressedSize - 4, file);
+    fclose(file);
+    result = parseWavefrontObjectFromFile(&wObj, path);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    remove(path);
+    free(compressed);
+    free(input);
+}
+#endif
+
+#ifndef COBJ_ZSTD
+// Read as plain text the magic would be one bad line that a lenient parser
+// skips, so only refusing zstd input outright fails this parse.
+void streamRejectsZstdWithoutSupport() {
+    const char *path = "bin/stream_test.obj.zst";
+    FILE *file = fopen(path, "wb");
+    fputs("\x28\xb5\x2f\xfd\nv 1 2 3\n", file);
+    fclose(file);
+
+    struct WavefrontObjectParser parser;
+    struct WavefrontObject wObj;
+    wavefrontObjectParserCompose(&parser);
+    parser.errorLimit = 5;
+    int result = wavefrontObjectParserParseFile(&parser, &wObj, path);
+    assertIntegersEqual(result, STATUS_PARSE_ERR);
+    assertIntegersEqual(parser.errorCount, 0);
+    wavefrontObjectParserRelease(&parser);
+    remove(path);
+}
+#endif
+
+void wavefrontObjectStreamTest() {
+    streamParsesLinesSplitAcrossBlocks();
+    streamParsesManyBlocks();
+    streamFailsOnBadLine();
+    streamFailsOnReaderError();
+    streamParsesPlainAndGzipFiles();
+#ifdef COBJ_ZSTD
+    streamParsesZstdFile();
+#else
+    streamRejectsZstdWithoutSupport();
+#endif
+}